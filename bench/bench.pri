@@ -0,0 +1,5 @@
+UTILS = $$PWD/../utils
+INCLUDEPATH += $$UTILS $$PWD
+
+HEADERS += \
+    $$PWD/screenframe.h
@@ -0,0 +1,54 @@
+#include <QtTest>
+
+#include "effectkernel.h"
+#include "screenframe.h"
+
+class BenchEffectKernel : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void apply_data();
+    void apply();
+};
+
+void BenchEffectKernel::initTestCase() {
+    // The kernels read their sizes from the settings, keep the user's
+    // config out of it.
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+void BenchEffectKernel::apply_data() {
+    QTest::addColumn<QString>("effect");
+    QTest::addColumn<QSize>("size");
+
+    QList<QPair<QString, QSize>> sizes;
+    sizes << qMakePair(QString("1080p"), QSize(1920, 1080))
+          << qMakePair(QString("4k"), QSize(3840, 2160))
+          << qMakePair(QString("8k"), QSize(7680, 4320));
+    foreach (QString effect, EffectKernel::names()) {
+        for (int i = 0; i < sizes.length(); i++) {
+            QTest::newRow(qPrintable(effect + " " + sizes[i].first))
+                    << effect << sizes[i].second;
+        }
+    }
+}
+
+void BenchEffectKernel::apply() {
+    QFETCH(QString, effect);
+    QFETCH(QSize, size);
+
+    QSharedPointer<const EffectKernel> kernel = EffectKernel::create(effect);
+    QVERIFY(kernel);
+
+    QImage img = screenFrame(size);
+    QImage result;
+    QBENCHMARK {
+        result = kernel->apply(img);
+    }
+    QCOMPARE(result.size(), size);
+}
+
+QTEST_GUILESS_MAIN(BenchEffectKernel)
+
+#include "bench_effectkernel.moc"
@@ -0,0 +1,21 @@
+QT       += core gui testlib
+
+TARGET = bench_effectkernel
+TEMPLATE = app
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+include(../bench.pri)
+
+SOURCES += bench_effectkernel.cpp \
+    $$UTILS/effectkernel.cpp \
+    $$UTILS/imagefilters.cpp \
+    $$UTILS/parallel.cpp \
+    $$UTILS/configsettings.cpp
+
+HEADERS += \
+    $$UTILS/effectkernel.h \
+    $$UTILS/imagefilters.h \
+    $$UTILS/parallel.h \
+    $$UTILS/configsettings.h
@@ -0,0 +1,72 @@
+#include <QtTest>
+#include <QBuffer>
+#include <QImageWriter>
+
+#include "pngencoder.h"
+#include "qoiencoder.h"
+#include "imagefilters.h"
+#include "screenframe.h"
+
+class BenchEncoders : public QObject {
+    Q_OBJECT
+
+private slots:
+    void encode_data();
+    void encode();
+};
+
+void BenchEncoders::encode_data() {
+    QTest::addColumn<QString>("encoder");
+    QTest::addColumn<QSize>("size");
+
+    QStringList encoders;
+    encoders << "png" << "png quantized" << "qoi" << "webp";
+    QList<QPair<QString, QSize>> sizes;
+    sizes << qMakePair(QString("1080p"), QSize(1920, 1080))
+          << qMakePair(QString("4k"), QSize(3840, 2160))
+          << qMakePair(QString("8k"), QSize(7680, 4320));
+    foreach (QString encoder, encoders) {
+        for (int i = 0; i < sizes.length(); i++) {
+            QTest::newRow(qPrintable(encoder + " " + sizes[i].first))
+                    << encoder << sizes[i].second;
+        }
+    }
+}
+
+/* Encodes to memory the way ImageWriter writes each format with its
+ * default settings, so only the encoder is timed and not the disk. */
+void BenchEncoders::encode() {
+    QFETCH(QString, encoder);
+    QFETCH(QSize, size);
+
+    if (encoder == "webp" && !QImageWriter::supportedImageFormats().contains("webp"))
+        QSKIP("no webp image plugin");
+
+    QImage img = screenFrame(size);
+    QByteArray data;
+    bool ok = false;
+    QBENCHMARK {
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::WriteOnly);
+        if (encoder == "png") {
+            ok = PngEncoder::write(img, &buffer);
+        } else if (encoder == "png quantized") {
+            // The quantize step is part of the save, time them together.
+            ok = PngEncoder::write(quantizeImage(img, 256), &buffer);
+        } else if (encoder == "qoi") {
+            ok = QoiEncoder::write(img, &buffer);
+        } else {
+            // Quality 100 is the default setting and lossless in webp.
+            QImageWriter writer(&buffer, "webp");
+            writer.setQuality(100);
+            ok = writer.write(img);
+        }
+    }
+    QVERIFY(ok);
+    qDebug() << "bytes:" << data.size()
+             << "ratio:" << qreal(data.size())/(size.width()*size.height()*3);
+}
+
+QTEST_GUILESS_MAIN(BenchEncoders)
+
+#include "bench_encoders.moc"
@@ -0,0 +1,23 @@
+QT       += core gui testlib
+
+TARGET = bench_encoders
+TEMPLATE = app
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+include(../bench.pri)
+
+LIBS += -lz
+
+SOURCES += bench_encoders.cpp \
+    $$UTILS/pngencoder.cpp \
+    $$UTILS/qoiencoder.cpp \
+    $$UTILS/imagefilters.cpp \
+    $$UTILS/parallel.cpp
+
+HEADERS += \
+    $$UTILS/pngencoder.h \
+    $$UTILS/qoiencoder.h \
+    $$UTILS/imagefilters.h \
+    $$UTILS/parallel.h
@@ -0,0 +1,40 @@
+#include <QtTest>
+
+#include "imagefilters.h"
+#include "screenframe.h"
+
+class BenchImageFilters : public QObject {
+    Q_OBJECT
+
+private slots:
+    void blurImage_data();
+    void blurImage();
+};
+
+void BenchImageFilters::blurImage_data() {
+    QTest::addColumn<QSize>("size");
+    QTest::addColumn<int>("radius");
+
+    QTest::newRow("1080p r10") << QSize(1920, 1080) << 10;
+    QTest::newRow("1080p r30") << QSize(1920, 1080) << 30;
+    QTest::newRow("4k r10") << QSize(3840, 2160) << 10;
+    QTest::newRow("4k r30") << QSize(3840, 2160) << 30;
+    QTest::newRow("8k r10") << QSize(7680, 4320) << 10;
+    QTest::newRow("8k r30") << QSize(7680, 4320) << 30;
+}
+
+void BenchImageFilters::blurImage() {
+    QFETCH(QSize, size);
+    QFETCH(int, radius);
+
+    QImage img = screenFrame(size);
+    QImage result;
+    QBENCHMARK {
+        result = ::blurImage(img, radius);
+    }
+    QCOMPARE(result.size(), size);
+}
+
+QTEST_APPLESS_MAIN(BenchImageFilters)
+
+#include "bench_imagefilters.moc"
@@ -0,0 +1,17 @@
+QT       += core gui testlib
+
+TARGET = bench_imagefilters
+TEMPLATE = app
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+include(../bench.pri)
+
+SOURCES += bench_imagefilters.cpp \
+    $$UTILS/imagefilters.cpp \
+    $$UTILS/parallel.cpp
+
+HEADERS += \
+    $$UTILS/imagefilters.h \
+    $$UTILS/parallel.h
@@ -0,0 +1,24 @@
+#ifndef SCREENFRAME_H
+#define SCREENFRAME_H
+
+#include <QImage>
+
+/* A stand-in for a grabbed screen: per pixel noise over a gradient, so
+ * no filter or encoder finds flat runs to skip. The noise comes from a
+ * private LCG, every call returns the same pixels. */
+inline QImage screenFrame(const QSize &size) {
+    QImage img(size, QImage::Format_RGB32);
+    quint32 state = 1000;
+    for (int y = 0; y < img.height(); y++) {
+        QRgb* line = reinterpret_cast<QRgb*>(img.scanLine(y));
+        for (int x = 0; x < img.width(); x++) {
+            state = state*1664525u + 1013904223u;
+            int noise = state >> 26;
+            line[x] = qRgb((x*255/img.width() + noise) & 0xff,
+                           (y*255/img.height() + noise) & 0xff, noise*4);
+        }
+    }
+    return img;
+}
+
+#endif // SCREENFRAME_H
@@ -14,7 +14,7 @@ TEMPLATE = app
 CONFIG += c++11 link_pkgconfig
 PKGCONFIG += xcb xcb-util dtkwidget dtkbase dtkutil
 
-LIBS += -lX11 -lXext -lXtst
+LIBS += -lX11 -lXext -lXtst -lz
 QMAKE_CXXFLAGS += -g
 
 SOURCES += main.cpp\
@@ -18,13 +18,17 @@ namespace {
 const int RECORD_MIN_SIZE = 10;
 const int SPACING = 5;
 const int TOOLBAR_Y_SPACING = 8;
+// save index of a --save-path write, it is not a save_op value
+const int SPECIFICED_PATH_SAVE = -1;
 }
 
 MainWindow::MainWindow(QWidget *parent)
     : QLabel(parent)
 {
 //     startScreenshot();
-
+    m_imageWriter = new ImageWriter(this);
+    connect(m_imageWriter, &ImageWriter::written, this, &MainWindow::onImageWritten);
+    m_effectPrecomputer = new EffectPrecomputer(this);
 }
 
 MainWindow::~MainWindow()
@@ -349,7 +353,7 @@ void MainWindow::keyPressEvent(QKeyEvent *ev) {
     }
 
     if (needRepaint) {
-        update();
+        updateSelection();
     }
 
     QLabel::keyPressEvent(ev);
@@ -376,7 +380,7 @@ void MainWindow::keyReleaseEvent(QKeyEvent *ev) {
         }
     }
     if (needRepaint) {
-        update();
+        updateSelection();
     }
     QLabel::keyReleaseEvent(ev);
 }
@@ -398,6 +402,7 @@ void MainWindow::mousePressEvent(QMouseEvent *ev) {
         if (!m_isFirstPressButton) {
             m_isFirstPressButton = true;
         } else if (ev->button() == Qt::LeftButton) {
+            m_effectPrecomputer->cancel();
             m_moving = true;
             m_dragAction = getDirection(ev);
 
@@ -488,10 +493,11 @@ void MainWindow::mouseReleaseEvent(QMouseEvent *ev) {
            m_isReleaseButton = true;
 
            needRepaint = true;
+           precomputeEffects();
        }
 
     if (needRepaint) {
-        update();
+        updateSelection();
     }
     QLabel::mouseReleaseEvent(ev);
 }
@@ -534,8 +540,9 @@ void MainWindow::mouseMoveEvent(QMouseEvent *ev) {
             qDebug() << "There is mouse move!";
 
             if ( !m_isFirstMove) {
+                // The dim changes on the whole screen.
                 m_isFirstMove = true;
-                needRepaint = true;
+                update();
             } else {
                 if (!m_toolBar->isVisible() && !m_isFirstReleaseButton) {
                     QPoint curPos = this->cursor().pos();
@@ -648,7 +655,7 @@ void MainWindow::mouseMoveEvent(QMouseEvent *ev) {
         }
 
     if (needRepaint) {
-        update();
+        updateSelection();
     }
 
     QLabel::mouseMoveEvent(ev);
@@ -707,36 +714,39 @@ int MainWindow::getDirection(QEvent *event) {
     }
 }
 void MainWindow::paintEvent(QPaintEvent *event)  {
-    Q_UNUSED(event);
+    // Only the invalidated region is composited, see updateSelection().
+    const QRegion dirtyRegion = event->region();
     QPainter painter(this);
     painter.setRenderHint(QPainter::Antialiasing, true);
+    painter.setClipRegion(dirtyRegion);
+
+    if (paintLog().isDebugEnabled()) {
+        qint64 repaintPixels = 0;
+        for (const QRect &rect : dirtyRegion.rects()) {
+            repaintPixels += qint64(rect.width())*rect.height();
+        }
+        qCDebug(paintLog) << "repaint pixels:" << repaintPixels << "of"
+                          << qint64(width())*height();
+    }
 
-    QRect backgroundRect = QRect(m_rootWindowRect.x, m_rootWindowRect.y,
-                                                              m_rootWindowRect.width, m_rootWindowRect.height);
-    // Draw background.
     if (!m_isFirstMove) {
-        painter.setBrush(QBrush("#000000"));
-        painter.setOpacity(0.5);
-        painter.drawRect(backgroundRect);
+        blitImage(painter, dimmedBackground(0.5), dirtyRegion);
     } else if (m_recordWidth > 0 && m_recordHeight > 0 && !m_drawNothing) {
         QRect frameRect = QRect(m_recordX + 1, m_recordY + 1, m_recordWidth - 2, m_recordHeight - 2);
         // Draw frame.
         if (m_mouseStatus != ShotMouseStatus::Wait) {
-            painter.setRenderHint(QPainter::Antialiasing, false);
-            painter.setBrush(QBrush("#000000"));
-            painter.setOpacity(0.2);
-            painter.setClipping(true);
-            painter.setClipRegion(QRegion(backgroundRect).subtracted(QRegion(frameRect)));
-            painter.drawRect(backgroundRect);
+            QRegion selectRegion = dirtyRegion.intersected(frameRect);
+            blitImage(painter, dimmedBackground(0.2), dirtyRegion.subtracted(selectRegion));
+            blitImage(painter, m_backgroundImg, selectRegion);
 
-            painter.setClipRegion(backgroundRect);
+            painter.setRenderHint(QPainter::Antialiasing, false);
             QPen framePen(QColor("#01bdff"));
             framePen.setWidth(2);
-            painter.setOpacity(1);
             painter.setBrush(Qt::transparent);
             painter.setPen(framePen);
             painter.drawRect(QRect(frameRect.x(), frameRect.y(), frameRect.width(), frameRect.height()));
-            painter.setClipping(false);
+        } else {
+            blitImage(painter, m_backgroundImg, dirtyRegion);
         }
 
         // Draw drag pint.
@@ -759,8 +769,58 @@ void MainWindow::paintEvent(QPaintEvent *event)  {
             paintSelectedPoint(painter, QPoint(paintWidth, paintHalfHeight), m_resizeBigPix);
             paintSelectedPoint(painter, QPoint(paintHalfWidth, paintHeight), m_resizeBigPix);
         }
+    } else {
+        blitImage(painter, m_backgroundImg, dirtyRegion);
+    }
+}
+
+void MainWindow::blitImage(QPainter &painter, const QImage &img, const QRegion &region) {
+    if (img.size() == size()) {
+        for (const QRect &rect : region.rects()) {
+            painter.drawImage(rect, img, rect);
+        }
+    } else if (!img.isNull()) {
+        // Scaled path, only taken if the frame doesn't match the window.
+        painter.save();
+        painter.setClipRegion(region);
+        painter.drawImage(this->rect(), img);
+        painter.restore();
+    }
+}
+
+const QImage &MainWindow::dimmedBackground(qreal opacity) {
+    // One cached copy is enough, the dim only changes on the first move.
+    if (m_dimmedImg.isNull() || m_dimmedOpacity != opacity) {
+        m_dimmedImg = m_backgroundImg.convertToFormat(QImage::Format_RGB32);
+        QPainter painter(&m_dimmedImg);
+        painter.setOpacity(opacity);
+        painter.fillRect(m_dimmedImg.rect(), Qt::black);
+        m_dimmedOpacity = opacity;
     }
 
+    return m_dimmedImg;
+}
+
+QRect MainWindow::selectionDirtyRect() {
+    if (m_recordWidth <= 0 || m_recordHeight <= 0)
+        return QRect();
+
+    // The handles are centered on the frame, the extra pixels cover the
+    // antialiased frame pen.
+    const int padding = m_resizeBigPix.width()/2 + 2;
+    return QRect(m_recordX, m_recordY, m_recordWidth, m_recordHeight).adjusted(
+                -padding, -padding, padding, padding);
+}
+
+void MainWindow::updateSelection() {
+    // Outside of the old and new frames the dim doesn't change.
+    QRect selectionRect = selectionDirtyRect();
+    QRegion dirtyRegion = QRegion(m_lastSelectionRect) | QRegion(selectionRect);
+    m_lastSelectionRect = selectionRect;
+
+    if (!dirtyRegion.isEmpty()) {
+        update(dirtyRegion);
+    }
 }
 
 void MainWindow::initShapeWidget(QString type) {
@@ -795,7 +855,7 @@ void MainWindow::initShapeWidget(QString type) {
     m_toolBar->showAt(toolbarPoint);
     m_toolBar->raise();
     m_needDrawSelectedPoint = false;
-    update();
+    updateSelection();
 
     connect(m_toolBar, &ToolBar::updateColor,
             m_shapesWidget, &ShapesWidget::setPenColor);
@@ -936,10 +996,7 @@ void MainWindow::fullScreenshot() {
      m_toolBar->hide();
      m_hotZoneInterface->asyncCall("EnableZoneDetected",  true);
 
-    using namespace utils;
-    QPixmap screenShotPix(TMP_FULLSCREEN_FILE);
-    saveAction(screenShotPix);
-    sendNotify(m_saveIndex, m_saveFileName);
+    saveAction(FrameStore::instance()->frame());
 }
 
 void MainWindow::savePath(const QString &path) {
@@ -966,7 +1023,7 @@ void MainWindow::saveSpecificedPath(QString path) {
         if (isValidFormat(suffix)) {
             savePath = path;
         } else if (suffix.isEmpty()) {
-            savePath = path + ".png";
+            savePath = path + "." + defaultSaveFormat();
         } else {
             qWarning() << "Invalid image format! Screenshot will quit, suffix:" << suffix;
             exitApp();
@@ -975,7 +1032,8 @@ void MainWindow::saveSpecificedPath(QString path) {
         QDateTime currentDate;
         QString currentTime =  currentDate.currentDateTime().
                 toString("yyyyMMddHHmmss");
-        savePath = path + QString(tr("DeepinScreenshot%1").arg(currentTime));
+        savePath = path + QString(tr("DeepinScreenshot%1").arg(currentTime))
+                + "." + defaultSaveFormat();
     }
 
     m_hotZoneInterface->asyncCall("EnableZoneDetected",  true);
@@ -983,30 +1041,8 @@ void MainWindow::saveSpecificedPath(QString path) {
     m_toolBar->setVisible(false);
     m_sizeTips->setVisible(false);
 
-    shotCurrentImg();
-
-    QPixmap screenShotPix(TMP_FILE);
-    screenShotPix.save(savePath);
-    QStringList actions;
-    actions << "_open" << tr("View");
-    QVariantMap hints;
-    QString fileDir = QUrl::fromLocalFile(QFileInfo(savePath).absoluteDir().absolutePath()).toString();
-    QString filePath =  QUrl::fromLocalFile(savePath).toString();
-    QString command;
-    if (QFile("/usr/bin/dde-file-manager").exists()) {
-        command = QString("/usr/bin/dde-file-manager,%1?selectUrl=%2"
-                          ).arg(fileDir).arg(filePath);
-    } else {
-        command = QString("xdg-open,%1").arg(filePath);
-    }
-
-    hints["x-deepin-action-_open"] = command;
-
-    QString summary = QString(tr("Picture has been saved to %1")).arg(savePath);
-
-    m_notifyDBInterface->Notify("Deepin Screenshot", 0,  "deepin-screenshot", "",
-                                summary, actions, hints, 0);
-    exitApp();
+    m_saveFileName = savePath;
+    m_imageWriter->write(shotCurrentImg(), savePath, QByteArray(), SPECIFICED_PATH_SAVE);
 }
 
 void MainWindow::delayScreenshot(int num) {
@@ -1064,12 +1100,9 @@ void MainWindow::topWindow() {
     }
 
     this->hide();
-    using namespace utils;
-    QPixmap screenShotPix = QPixmap(TMP_FULLSCREEN_FILE).copy(m_recordX, m_recordY,
-                                                              m_recordWidth, m_recordHeight);
     m_needSaveScreenshot = true;
-    saveAction(screenShotPix);
-    sendNotify(m_saveIndex, m_saveFileName);
+    saveAction(FrameStore::instance()->region(
+                   QRect(m_recordX, m_recordY, m_recordWidth, m_recordHeight)));
 }
 
 void MainWindow::startScreenshot() {
@@ -1111,36 +1144,31 @@ void MainWindow::responseEsc()
 }
 
 void MainWindow::initBackground() {
-    QList<QScreen*> screenList = qApp->screens();
-    QPixmap tmpImg =  screenList[m_screenNum]->grabWindow(
-                qApp->desktop()->screen(m_screenNum)->winId(),
-                m_backgroundRect.x(), m_backgroundRect.y(),
-                m_backgroundRect.width(), m_backgroundRect.height());
-
     using namespace utils;
-    tmpImg.save(TMP_FULLSCREEN_FILE, "png");
-    this->setStyleSheet(QString("MainWindow{ border-image: url(%1); }"
-                                       ).arg(TMP_FULLSCREEN_FILE));
+    m_backgroundImg = ScreenGrabber::instance()->grabFrame(m_screenNum, m_backgroundRect);
+    m_dimmedImg = QImage();
+    FrameStore::instance()->setFrame(m_backgroundImg);
+    FrameStore::dumpImage(m_backgroundImg, TMP_FULLSCREEN_FILE);
 }
 
 void MainWindow::shotFullScreen() {
-    QList<QScreen*> screenList = qApp->screens();
-    QPixmap tmpImg =  screenList[m_screenNum]->grabWindow(
-                qApp->desktop()->screen(m_screenNum)->winId(),
-                m_backgroundRect.x(), m_backgroundRect.y(),
-                m_backgroundRect.width(), m_backgroundRect.height());
-
     using namespace utils;
-    tmpImg.save(TMP_FULLSCREEN_FILE, "png");
+    QImage frameImg = ScreenGrabber::instance()->grabFrame(m_screenNum, m_backgroundRect);
+    FrameStore::instance()->setFrame(frameImg);
+    FrameStore::dumpImage(frameImg, TMP_FULLSCREEN_FILE);
 }
 
-void MainWindow::shotCurrentImg() {
+QImage MainWindow::shotCurrentImg() {
     if (m_recordWidth == 0 || m_recordHeight == 0)
-        return;
+        return QImage();
+
+    if (isFrozenFrame()) {
+        return composeFrozenImg();
+    }
 
     m_needDrawSelectedPoint = false;
     m_drawNothing = true;
-    update();
+    updateSelection();
 
     QEventLoop eventloop1;
     QTimer::singleShot(100, &eventloop1, SLOT(quit()));
@@ -1156,34 +1184,72 @@ void MainWindow::shotCurrentImg() {
     this->hide();
     emit hideScreenshotUI();
 
-    QPixmap tmpImg(TMP_FULLSCREEN_FILE);
-    tmpImg = tmpImg.copy(QRect(m_recordX, m_recordY, m_recordWidth, m_recordHeight));
-    tmpImg.save(TMP_FILE, "png");
+    QImage tmpImg = FrameStore::instance()->region(
+                QRect(m_recordX, m_recordY, m_recordWidth, m_recordHeight));
+    FrameStore::dumpImage(tmpImg, TMP_FILE);
+    return tmpImg;
 }
 
-void MainWindow::shotImgWidthEffect() {
+QImage MainWindow::shotImgWidthEffect() {
     if (m_recordWidth == 0 || m_recordHeight == 0)
-        return;
+        return QImage();
+
+    using namespace utils;
+    if (isFrozenFrame()) {
+        QImage effectImg = FrameStore::instance()->region(
+                    QRect(m_recordX, m_recordY, m_recordWidth, m_recordHeight));
+        FrameStore::dumpImage(effectImg, TMP_FILE);
+        return effectImg;
+    }
 
     m_needDrawSelectedPoint = false;
     m_drawNothing = true;
-    update();
+    updateSelection();
 
     QEventLoop eventloop;
     QTimer::singleShot(100, &eventloop, SLOT(quit()));
     eventloop.exec();
 
     qDebug() << m_toolBar->isVisible() << m_sizeTips->isVisible();
-    QList<QScreen*> screenList = qApp->screens();
-    QPixmap tmpImg =  screenList[m_screenNum]->grabWindow(
-                qApp->desktop()->screen(m_screenNum)->winId(),
-                m_recordX + m_backgroundRect.x(), m_recordY, m_recordWidth, m_recordHeight);
-    qDebug() << tmpImg.isNull() << tmpImg.size();
+    // Effect layers keep their input to filter tiles later on, so it
+    // must not borrow the grabber's buffer.
+    QImage effectImg = ScreenGrabber::instance()->grabFrame(m_screenNum,
+                QRect(m_recordX + m_backgroundRect.x(), m_recordY, m_recordWidth, m_recordHeight));
+    qDebug() << effectImg.isNull() << effectImg.size();
 
-    using namespace utils;
-    tmpImg.save(TMP_FILE, "png");
+    FrameStore::dumpImage(effectImg, TMP_FILE);
     m_drawNothing = false;
-    update();
+    updateSelection();
+
+    return effectImg;
+}
+
+bool MainWindow::isFrozenFrame() {
+    return ConfigSettings::instance()->value("capture", "frozen_frame", true).toBool();
+}
+
+QImage MainWindow::composeFrozenImg() {
+    using namespace utils;
+    QImage resultImg = FrameStore::instance()->region(
+                QRect(m_recordX, m_recordY, m_recordWidth, m_recordHeight)).copy();
+    if (resultImg.isNull())
+        return resultImg;
+
+    if (m_isShapesWidgetExist) {
+        // Render the annotations on top of the initial grab without the
+        // selection handles, the shapes widget sits 2px inside the record rect.
+        m_shapesWidget->clearSelected();
+        QPainter painter(&resultImg);
+        m_shapesWidget->render(&painter, QPoint(2, 2), QRegion(),
+                               QWidget::DrawChildren);
+        m_shapesWidget->hide();
+    }
+
+    this->hide();
+    emit hideScreenshotUI();
+
+    FrameStore::dumpImage(resultImg, TMP_FILE);
+    return resultImg;
 }
 
 void MainWindow::saveScreenshot() {
@@ -1195,18 +1261,19 @@ void MainWindow::saveScreenshot() {
     m_toolBar->setVisible(false);
     m_sizeTips->setVisible(false);
 
-    shotCurrentImg();
-
-    using namespace utils;
-    saveAction(utils::TMP_FILE);
-    sendNotify(m_saveIndex, m_saveFileName);
+    saveAction(shotCurrentImg());
 }
 
-void MainWindow::saveAction(QPixmap pix) {
+void MainWindow::saveAction(QImage img) {
     emit releaseEvent();
+    // Effects nobody asked for yet must not slow down the save.
+    m_effectPrecomputer->cancel();
+    // The overlay goes away right now, the encoding runs in the background.
+    this->hide();
+    emit hideScreenshotUI();
 
     using namespace utils;
-    QPixmap screenShotPix = pix;
+    QImage screenShotImg = img;
     QDateTime currentDate;
     QString currentTime =  currentDate.currentDateTime().
             toString("yyyyMMddHHmmss");
@@ -1230,8 +1297,8 @@ void MainWindow::saveAction(QPixmap pix) {
             copyToClipboard = true;
             m_saveIndex = 3;
         } else {
-            m_saveFileName = QString("%1/%2%3.png").arg(defaultSaveDir).arg(tr(
-                                                                           "DeepinScreenshot")).arg(currentTime);
+            m_saveFileName = QString("%1/%2%3.%4").arg(defaultSaveDir).arg(tr(
+                                                                           "DeepinScreenshot")).arg(currentTime).arg(defaultSaveFormat());
         }
         break;
     }
@@ -1239,11 +1306,11 @@ void MainWindow::saveAction(QPixmap pix) {
         this->hide();
         this->releaseKeyboard();
         QFileDialog fileDialog;
-        QString  lastFileName = QString("%1/%2%3.png").arg(QStandardPaths::writableLocation(
-                        QStandardPaths::PicturesLocation)).arg(tr("DeepinScreenshot")).arg(currentTime);
+        QString  lastFileName = QString("%1/%2%3.%4").arg(QStandardPaths::writableLocation(
+                        QStandardPaths::PicturesLocation)).arg(tr("DeepinScreenshot")).arg(currentTime).arg(defaultSaveFormat());
         m_saveFileName =  fileDialog.getSaveFileName(this, "Save",  lastFileName,
                                                      tr("PNG (*.png);;JPEG (*.jpg *.jpeg);; BMP (*.bmp);; PGM (*.pgm);;"
-                                                        "XBM (*.xbm);;XPM(*.xpm);;"));
+                                                        "XBM (*.xbm);;XPM(*.xpm);;QOI (*.qoi);;WebP (*.webp);;"));
         if (m_saveFileName.isEmpty()) {
             exitApp();
         }
@@ -1271,8 +1338,8 @@ void MainWindow::saveAction(QPixmap pix) {
         } else if (defaultSaveDir == "clipboard") {
             m_saveIndex = 3;
         } else  {
-            m_saveFileName = QString("%1/%2%3.png").arg(defaultSaveDir).arg(tr(
-                                                                               "DeepinScreenshot")).arg(currentTime);
+            m_saveFileName = QString("%1/%2%3.%4").arg(defaultSaveDir).arg(tr(
+                                                                               "DeepinScreenshot")).arg(currentTime).arg(defaultSaveFormat());
         }
         break;
     }
@@ -1280,35 +1347,29 @@ void MainWindow::saveAction(QPixmap pix) {
         break;
     }
 
-    int toolBarSaveQuality = std::min(ConfigSettings::instance()->value("save",
-                                                            "save_quality").toInt(), 100);
-
-    if (toolBarSaveQuality != 100) {
-       qreal saveQuality = qreal(toolBarSaveQuality)*5/1000 + 0.5;
-
-       int pixWidth = screenShotPix.width();
-       int pixHeight = screenShotPix.height();
-        screenShotPix = screenShotPix.scaled(pixWidth*saveQuality, pixHeight*saveQuality,
-                                                                             Qt::KeepAspectRatio, Qt::FastTransformation);
-        screenShotPix = screenShotPix.scaled(pixWidth,  pixHeight,
-                                                                            Qt::KeepAspectRatio, Qt::FastTransformation);
-    }
-
+    bool needWrite = false;
     if (m_saveIndex ==2 && m_saveFileName.isEmpty()) {
         exitApp();
         return;
     } else if (m_saveIndex == 2 || !m_saveFileName.isEmpty()) {
-        screenShotPix.save(m_saveFileName,  QFileInfo(m_saveFileName).suffix().toLocal8Bit());
+        needWrite = true;
     } else if (saveOption != QStandardPaths::TempLocation || m_saveFileName.isEmpty()) {
-        m_saveFileName = QString("%1/%2%3.png").arg(QStandardPaths::writableLocation(
-                             saveOption)).arg(tr("DeepinScreenshot")).arg(currentTime);
-        screenShotPix.save(m_saveFileName,  "PNG");
+        m_saveFileName = QString("%1/%2%3.%4").arg(QStandardPaths::writableLocation(
+                             saveOption)).arg(tr("DeepinScreenshot")).arg(currentTime).arg(defaultSaveFormat());
+        needWrite = true;
     }
 
     if (copyToClipboard) {
-        Q_ASSERT(!screenShotPix.isNull());
+        Q_ASSERT(!screenShotImg.isNull());
         QClipboard* cb = qApp->clipboard();
-        cb->setPixmap(screenShotPix, QClipboard::Clipboard);
+        cb->setImage(screenShotImg, QClipboard::Clipboard);
+    }
+
+    // The notification goes out from onImageWritten once the file is on disk.
+    if (needWrite) {
+        m_imageWriter->write(screenShotImg, m_saveFileName, QByteArray(), m_saveIndex);
+    } else {
+        sendNotify(m_saveIndex, m_saveFileName);
     }
 }
 
@@ -1347,34 +1408,118 @@ void MainWindow::sendNotify(int saveIndex, QString saveFilePath) {
    }
 
    QTimer::singleShot(4000, this, [=]{
-          qApp->quit();
+          exitApp();
    });
 }
 
-void MainWindow::reloadImage(QString effect) {
-    //**save tmp image file
-    shotImgWidthEffect();
-    using namespace utils;
-    const int radius = 10;
-    QPixmap tmpImg(TMP_FILE);
-    int imgWidth = tmpImg.width();
-    int imgHeight = tmpImg.height();
-    if (effect == "blur") {
-        if (!tmpImg.isNull()) {
-            tmpImg = tmpImg.scaled(imgWidth/radius, imgHeight/radius,
-                                     Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
-            tmpImg = tmpImg.scaled(imgWidth, imgHeight, Qt::IgnoreAspectRatio,
-                                     Qt::SmoothTransformation);
-            tmpImg.save(TMP_BLUR_FILE, "png");
-        }
+void MainWindow::notifySpecificedPath(QString saveFilePath) {
+    // A --save-path save always notifies and quits at once.
+    QStringList actions;
+    actions << "_open" << tr("View");
+    QVariantMap hints;
+    QString fileDir = QUrl::fromLocalFile(QFileInfo(saveFilePath).absoluteDir().absolutePath()).toString();
+    QString filePath =  QUrl::fromLocalFile(saveFilePath).toString();
+    QString command;
+    if (QFile("/usr/bin/dde-file-manager").exists()) {
+        command = QString("/usr/bin/dde-file-manager,%1?selectUrl=%2"
+                          ).arg(fileDir).arg(filePath);
     } else {
-        if (!tmpImg.isNull()) {
-            tmpImg = tmpImg.scaled(imgWidth/radius, imgHeight/radius,
-                                   Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
-            tmpImg = tmpImg.scaled(imgWidth, imgHeight);
-            tmpImg.save(TMP_MOSA_FILE, "png");
-        }
+        command = QString("xdg-open,%1").arg(filePath);
     }
+
+    hints["x-deepin-action-_open"] = command;
+
+    QString summary = QString(tr("Picture has been saved to %1")).arg(saveFilePath);
+
+    m_notifyDBInterface->Notify("Deepin Screenshot", 0,  "deepin-screenshot", "",
+                                summary, actions, hints, 0);
+    exitApp();
+}
+
+QString MainWindow::defaultSaveFormat() {
+    QString format = ConfigSettings::instance()->value("save", "format", "png").toString().toLower();
+    if (!isValidFormat(format)) {
+        qWarning() << "Invalid default save format:" << format;
+        return "png";
+    }
+
+    return format;
+}
+
+void MainWindow::onImageWritten(const QString &path, bool ok, const QVariant &saveIndex) {
+    if (!ok) {
+        qWarning() << "Failed to save screenshot:" << path;
+        exitApp();
+        return;
+    }
+
+    if (saveIndex.toInt() == SPECIFICED_PATH_SAVE) {
+        notifySpecificedPath(path);
+    } else {
+        sendNotify(saveIndex.toInt(), path);
+    }
+}
+
+void MainWindow::reloadImage(QString effect) {
+    if (!m_isShapesWidgetExist)
+        return;
+
+    EffectLayer layer = effectLayer(effect);
+    if (!layer.isNull()) {
+        m_shapesWidget->setEffectLayer(effect, layer);
+    }
+}
+
+QString MainWindow::effectLayerKey(const QSharedPointer<const EffectKernel> &kernel) {
+    return QString("%1/%2,%3,%4x%5").arg(kernel->key()).arg(m_recordX)
+            .arg(m_recordY).arg(m_recordWidth).arg(m_recordHeight);
+}
+
+EffectLayer MainWindow::effectLayer(const QString &effect) {
+    QSharedPointer<const EffectKernel> kernel = EffectKernel::create(effect);
+    if (!kernel)
+        return EffectLayer();
+
+    const QString key = effectLayerKey(kernel);
+    if (m_effectLayers.contains(key))
+        return m_effectLayers.value(key);
+
+    QImage tmpImg = shotImgWidthEffect();
+    if (tmpImg.isNull())
+        return EffectLayer();
+
+    // The shapes widget sits 2px inside the record rect, the layer
+    // filters only the tiles which effect shapes cover.
+    EffectLayer layer(tmpImg, QPoint(2, 2), kernel);
+    m_effectLayers.insert(key, layer);
+    return layer;
+}
+
+void MainWindow::precomputeEffects() {
+    // Without a frozen frame the effect input is a fresh grab, which
+    // can't be taken while the overlay is shown.
+    if (!isFrozenFrame() || m_isShapesWidgetExist
+            || m_recordWidth == 0 || m_recordHeight == 0)
+        return;
+
+    m_effectPrecomputer->cancel();
+    // Layers of an older selection are never used again, cheap kernels
+    // are left to compute their tiles on demand.
+    QHash<QString, EffectLayer> oldLayers = m_effectLayers;
+    QList<EffectLayer> layers;
+    m_effectLayers.clear();
+    foreach (QString effect, EffectKernel::names()) {
+        QSharedPointer<const EffectKernel> kernel = EffectKernel::create(effect);
+        if (!kernel->isExpensive())
+            continue;
+
+        QString key = effectLayerKey(kernel);
+        if (oldLayers.contains(key))
+            m_effectLayers.insert(key, oldLayers.value(key));
+        layers.append(effectLayer(effect));
+    }
+
+    m_effectPrecomputer->precompute(layers);
 }
 
 void MainWindow::onViewShortcut() {
@@ -1413,5 +1558,8 @@ void MainWindow::exitApp() {
     if (m_interfaceExist && nullptr != m_hotZoneInterface) {
         m_hotZoneInterface->asyncCall("EnableZoneDetected",  true);
     }
+    m_effectPrecomputer->cancel();
+    // Don't leave a half written file behind.
+    m_imageWriter->waitForFlushed();
     qApp->quit();
 }
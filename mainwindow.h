@@ -19,6 +19,11 @@
 #include "utils/baseutils.h"
 #include "utils/shortcut.h"
 #include "utils/configsettings.h"
+#include "utils/framestore.h"
+#include "utils/screengrabber.h"
+#include "utils/imagewriter.h"
+#include "utils/imagefilters.h"
+#include "utils/effectprecomputer.h"
 #include "controller/menucontroller.h"
 
 #include "dbusinterface/dbuscontrolcenter.h"
@@ -47,6 +52,8 @@ public:
     void initShapeWidget(QString type);
     void initDBusInterface();
     void initShortcut();
+    /* crop saves and effect inputs from the initial grab */
+    bool isFrozenFrame();
 
 signals:
     void deleteShapes();
@@ -70,11 +77,14 @@ public slots:
     void showReleaseFeedback(int x, int y);
     void responseEsc();
     void shotFullScreen();
-    void shotCurrentImg();
-    void shotImgWidthEffect();
+    QImage shotCurrentImg();
+    QImage shotImgWidthEffect();
     void saveScreenshot();
-    void saveAction(QPixmap pix);
+    void saveAction(QImage img);
     void sendNotify(int saveIndex, QString saveFilePath);
+    void notifySpecificedPath(QString saveFilePath);
+    QString defaultSaveFormat();
+    void onImageWritten(const QString &path, bool ok, const QVariant &saveIndex);
     void reloadImage(QString effect);
     void onViewShortcut();
     void onHelp();
@@ -85,6 +95,17 @@ protected:
     int   getDirection(QEvent *event);
     void updateCursor(QEvent *event);
     void resizeDirection(ResizeDirection direction, QMouseEvent* e);
+    /* the area covered by the selection frame and its drag handles */
+    QRect selectionDirtyRect();
+    void updateSelection();
+    /* 1:1 copy of the region of img, which has the window size */
+    void blitImage(QPainter &painter, const QImage &img, const QRegion &region);
+    const QImage &dimmedBackground(qreal opacity);
+    QImage composeFrozenImg();
+    /* effect layers are cached per effect, parameter and selection */
+    QString effectLayerKey(const QSharedPointer<const EffectKernel> &kernel);
+    EffectLayer effectLayer(const QString &effect);
+    void precomputeEffects();
 
     void keyPressEvent(QKeyEvent *ev) Q_DECL_OVERRIDE;
     void keyReleaseEvent(QKeyEvent *ev) Q_DECL_OVERRIDE;
@@ -137,6 +158,10 @@ private:
     bool m_needSaveScreenshot = false;
 
     QString m_selectAreaName;
+    QImage m_backgroundImg;
+    QImage m_dimmedImg;
+    qreal m_dimmedOpacity = 0;
+    QRect m_lastSelectionRect;
     QPixmap m_resizeBigPix;
     QPixmap m_resizeSmallPix;
 
@@ -145,6 +170,9 @@ private:
     ZoomIndicator* m_zoomIndicator;
     ShapesWidget* m_shapesWidget;
     ConfigSettings* m_configSettings;
+    ImageWriter* m_imageWriter;
+    EffectPrecomputer* m_effectPrecomputer;
+    QHash<QString, EffectLayer> m_effectLayers;
 
     bool m_isShapesWidgetExist = false;
     bool m_interfaceExist = false;
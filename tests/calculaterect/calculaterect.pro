@@ -0,0 +1,20 @@
+QT       += core gui testlib
+
+TARGET = tst_calculaterect
+TEMPLATE = app
+
+CONFIG += c++11 testcase console
+CONFIG -= app_bundle
+
+UTILS = $$PWD/../../utils
+INCLUDEPATH += $$UTILS
+
+SOURCES += tst_calculaterect.cpp \
+    $$UTILS/calculaterect.cpp \
+    $$UTILS/shapesutils.cpp \
+    $$UTILS/strokeindex.cpp
+
+HEADERS += \
+    $$UTILS/calculaterect.h \
+    $$UTILS/shapesutils.h \
+    $$UTILS/strokeindex.h
@@ -0,0 +1,177 @@
+#include <QtTest>
+#include <QtMath>
+
+#include <cmath>
+
+#include "calculaterect.h"
+
+namespace {
+const qreal ELLIPSE_PADDING = 10;
+
+/* the four main points of an axis aligned rect, the order of getMainPoints
+ * without its 4px minimum size */
+FourPoints rectPoints(qreal x, qreal y, qreal width, qreal height) {
+    FourPoints rectFPoints;
+    rectFPoints << QPointF(x, y) << QPointF(x, y + height)
+                << QPointF(x + width, y) << QPointF(x + width, y + height);
+    return rectFPoints;
+}
+
+FourPoints rotatedEllipse(QPointF center, qreal width, qreal height, qreal angle) {
+    FourPoints rectFPoints = rectPoints(center.x() - width/2, center.y() - height/2,
+                                        width, height);
+    for (int k = 0; k < rectFPoints.length(); k++)
+        rectFPoints[k] = pointRotate(center, rectFPoints[k], angle);
+    return rectFPoints;
+}
+
+/* distance from pos to the ellipse inscribed in rectFPoints, sampled every
+ * half pixel or less, so it is at most a quarter pixel too large */
+qreal curveDistance(const FourPoints &rectFPoints, QPointF pos) {
+    QPointF center = (rectFPoints[0] + rectFPoints[3])/2;
+    QPointF xAxis = (rectFPoints[2] + rectFPoints[3])/2 - center;
+    QPointF yAxis = (rectFPoints[1] + rectFPoints[3])/2 - center;
+    qreal radius = std::max(getDistance(xAxis, QPointF(0, 0)),
+                            getDistance(yAxis, QPointF(0, 0)));
+    int samples = std::max(64, int(4*M_PI*radius));
+    qreal best = -1;
+    for (int k = 0; k < samples; k++) {
+        qreal t = 2*M_PI*k/samples;
+        qreal distance = getDistance(center + xAxis*std::cos(t) + yAxis*std::sin(t), pos);
+        if (best < 0 || distance < best)
+            best = distance;
+    }
+    return best;
+}
+
+struct EllipseQueries {
+    QList<FourPoints> ellipses;
+    QList<QPointF> queries;
+    int queryCount;
+};
+
+/* ellipses from 20px to 1500px wide at any angle, the even queries lie
+ * within 20px of the curve and the odd ones up to twice its radius out,
+ * so a failing query is found again on the next run */
+EllipseQueries randomQueries(int ellipseCount, int queryCount) {
+    EllipseQueries result;
+    result.queryCount = queryCount;
+    qsrand(1000);
+    for (int i = 0; i < ellipseCount; i++) {
+        QPointF center(qrand() % 1920, qrand() % 1080);
+        qreal width = 20 + qrand() % 1500;
+        qreal height = 20 + qrand() % 1000;
+        qreal angle = qDegreesToRadians(qreal(qrand() % 360));
+        result.ellipses.append(rotatedEllipse(center, width, height, angle));
+
+        for (int j = 0; j < queryCount; j++) {
+            qreal t = qDegreesToRadians((qrand() % 3600)/10.0);
+            qreal scale = j % 2 ? (qrand() % 200)/100.0
+                                : 1 + (qrand() % 41 - 20)/qMin(width, height);
+            QPointF onCircle(std::cos(t)*width/2*scale, std::sin(t)*height/2*scale);
+            result.queries.append(pointRotate(center, center + onCircle, angle));
+        }
+    }
+    return result;
+}
+}
+
+class TestCalculateRect : public QObject {
+    Q_OBJECT
+
+private slots:
+    void ellipseHit_data();
+    void ellipseHit();
+    void ellipseHitMatchesCurve();
+    void ellipseHitBenchmark_data();
+    void ellipseHitBenchmark();
+};
+
+void TestCalculateRect::ellipseHit_data() {
+    QTest::addColumn<FourPoints>("rect");
+    QTest::addColumn<QPointF>("pos");
+    QTest::addColumn<bool>("hit");
+
+    QTest::newRow("on the major axis inside") << rectPoints(0, 0, 200, 100) << QPointF(195, 50) << true;
+    QTest::newRow("on the major axis outside") << rectPoints(0, 0, 200, 100) << QPointF(208, 50) << true;
+    QTest::newRow("past the major axis") << rectPoints(0, 0, 200, 100) << QPointF(212, 50) << false;
+    QTest::newRow("on the minor axis") << rectPoints(0, 0, 200, 100) << QPointF(100, 95) << true;
+    QTest::newRow("inside on the minor axis") << rectPoints(0, 0, 200, 100) << QPointF(100, 80) << false;
+    QTest::newRow("center of a large ellipse") << rectPoints(0, 0, 200, 100) << QPointF(100, 50) << false;
+    QTest::newRow("center of a small circle") << rectPoints(0, 0, 10, 10) << QPointF(5, 5) << true;
+    QTest::newRow("center of a large circle") << rectPoints(0, 0, 100, 100) << QPointF(50, 50) << false;
+    QTest::newRow("center of a flat ellipse") << rectPoints(0, 0, 200, 10) << QPointF(100, 5) << true;
+    QTest::newRow("tip of a thin ellipse") << rectPoints(0, 0, 200, 4) << QPointF(200, 2) << true;
+    QTest::newRow("zero height on the line") << rectPoints(0, 0, 200, 0) << QPointF(100, 0) << true;
+    QTest::newRow("zero height away") << rectPoints(0, 0, 200, 0) << QPointF(100, 30) << false;
+    QTest::newRow("zero width on the line") << rectPoints(0, 0, 0, 200) << QPointF(0, 100) << true;
+    QTest::newRow("zero size on the point") << rectPoints(10, 10, 0, 0) << QPointF(10, 10) << true;
+    QTest::newRow("zero size away") << rectPoints(10, 10, 0, 0) << QPointF(40, 40) << false;
+}
+
+void TestCalculateRect::ellipseHit() {
+    QFETCH(FourPoints, rect);
+    QFETCH(QPointF, pos);
+    QFETCH(bool, hit);
+
+    QCOMPARE(pointOnEllipse(rect, pos), hit);
+}
+
+void TestCalculateRect::ellipseHitMatchesCurve() {
+    EllipseQueries random = randomQueries(40, 250);
+    int onlySampled = 0;
+    int onlyAnalytic = 0;
+    for (int i = 0; i < random.ellipses.length(); i++) {
+        const FourPoints &rectFPoints = random.ellipses[i];
+        for (int j = 0; j < random.queryCount; j++) {
+            QPointF pos = random.queries[i*random.queryCount + j];
+            bool analytic = pointOnEllipse(rectFPoints, pos);
+            bool sampled = pointOnEllipseSampled(rectFPoints, pos);
+            qreal distance = curveDistance(rectFPoints, pos);
+
+            // Every hit is within the padding of the curve, and no point
+            // clearly within it is missed.
+            if (analytic && distance > ELLIPSE_PADDING + 0.5)
+                QFAIL(qPrintable(QString("hit %1 px away").arg(distance)));
+            if (!analytic && distance < ELLIPSE_PADDING - 0.5)
+                QFAIL(qPrintable(QString("missed %1 px away").arg(distance)));
+            // The sampled test only hits beyond the curve in the corners
+            // of its boxes.
+            if (sampled && !analytic && distance < ELLIPSE_PADDING - 1)
+                QFAIL(qPrintable(QString("only sampled %1 px away").arg(distance)));
+
+            onlySampled += sampled && !analytic;
+            onlyAnalytic += analytic && !sampled;
+        }
+    }
+    qDebug() << "only sampled:" << onlySampled << "only analytic:" << onlyAnalytic;
+}
+
+void TestCalculateRect::ellipseHitBenchmark_data() {
+    QTest::addColumn<bool>("sampled");
+
+    QTest::newRow("sampled") << true;
+    QTest::newRow("analytic") << false;
+}
+
+void TestCalculateRect::ellipseHitBenchmark() {
+    QFETCH(bool, sampled);
+
+    EllipseQueries random = randomQueries(200, 500);
+    int hits = 0;
+    QBENCHMARK {
+        hits = 0;
+        for (int i = 0; i < random.ellipses.length(); i++) {
+            for (int j = 0; j < random.queryCount; j++) {
+                QPointF pos = random.queries[i*random.queryCount + j];
+                hits += sampled ? pointOnEllipseSampled(random.ellipses[i], pos)
+                                : pointOnEllipse(random.ellipses[i], pos);
+            }
+        }
+    }
+    QVERIFY(hits > 0);
+}
+
+QTEST_APPLESS_MAIN(TestCalculateRect)
+
+#include "tst_calculaterect.moc"
@@ -0,0 +1,17 @@
+QT       += core testlib
+QT       -= gui
+
+TARGET = tst_shapeindex
+TEMPLATE = app
+
+CONFIG += c++11 testcase console
+CONFIG -= app_bundle
+
+UTILS = $$PWD/../../utils
+INCLUDEPATH += $$UTILS
+
+SOURCES += tst_shapeindex.cpp \
+    $$UTILS/shapeindex.cpp
+
+HEADERS += \
+    $$UTILS/shapeindex.h
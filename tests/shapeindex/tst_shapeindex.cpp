@@ -0,0 +1,135 @@
+#include <QtTest>
+
+#include "shapeindex.h"
+
+namespace {
+/* random bounds over a 1080p screen, some reach past its edges into
+ * negative cells and every 50th is empty, drawn from the seed init()
+ * sets before each test */
+QVector<QRect> randomBounds(int count) {
+    QVector<QRect> bounds;
+    for (int i = 0; i < count; i++) {
+        if (i % 50 == 0) {
+            bounds.append(QRect());
+        } else {
+            bounds.append(QRect(qrand() % 2000 - 40, qrand() % 1160 - 40,
+                                20 + qrand() % 300, 20 + qrand() % 200));
+        }
+    }
+    return bounds;
+}
+
+QVector<QPoint> randomQueries(int count) {
+    QVector<QPoint> queries;
+    for (int i = 0; i < count; i++)
+        queries.append(QPoint(qrand() % 2000 - 40, qrand() % 1160 - 40));
+    // Both sides of the cell edges, the negative ones included.
+    for (int edge = -128; edge <= 128; edge += 64) {
+        for (int offset = -1; offset <= 0; offset++) {
+            queries.append(QPoint(edge + offset, edge + offset));
+            queries.append(QPoint(edge + offset, 500));
+            queries.append(QPoint(500, edge + offset));
+        }
+    }
+    return queries;
+}
+
+QVector<int> linearCandidates(const QVector<QRect> &bounds, const QPoint &pos) {
+    QVector<int> result;
+    for (int i = 0; i < bounds.size(); i++) {
+        if (bounds[i].contains(pos))
+            result.append(i);
+    }
+    return result;
+}
+}
+
+class TestShapeIndex : public QObject {
+    Q_OBJECT
+
+private slots:
+    void init();
+    void matchesLinearScan();
+    void matchesLinearScanAfterEdits();
+    void clear();
+    void candidatesBenchmark_data();
+    void candidatesBenchmark();
+};
+
+void TestShapeIndex::init() {
+    qsrand(1000);
+}
+
+void TestShapeIndex::matchesLinearScan() {
+    QVector<QRect> bounds = randomBounds(500);
+    ShapeIndex index;
+    foreach (QRect rect, bounds)
+        index.append(rect);
+    QCOMPARE(index.count(), bounds.size());
+
+    foreach (QPoint pos, randomQueries(5000))
+        QCOMPARE(index.candidates(pos), linearCandidates(bounds, pos));
+}
+
+void TestShapeIndex::matchesLinearScanAfterEdits() {
+    QVector<QRect> bounds = randomBounds(300);
+    ShapeIndex index;
+    foreach (QRect rect, bounds)
+        index.append(rect);
+
+    // Moved shapes append to their new cells, removed ones shift the rest.
+    for (int i = 0; i < 200; i++) {
+        int changed = qrand() % bounds.size();
+        if (i % 4 == 0) {
+            bounds.remove(changed);
+            index.removeAt(changed);
+        } else {
+            QRect moved = bounds[changed].translated(qrand() % 200 - 100, qrand() % 200 - 100);
+            bounds[changed] = moved;
+            index.update(changed, moved);
+        }
+    }
+    QCOMPARE(index.count(), bounds.size());
+
+    foreach (QPoint pos, randomQueries(5000))
+        QCOMPARE(index.candidates(pos), linearCandidates(bounds, pos));
+}
+
+void TestShapeIndex::clear() {
+    ShapeIndex index;
+    index.append(QRect(0, 0, 100, 100));
+    index.clear();
+    QCOMPARE(index.count(), 0);
+    QVERIFY(index.candidates(QPoint(50, 50)).isEmpty());
+}
+
+void TestShapeIndex::candidatesBenchmark_data() {
+    QTest::addColumn<bool>("linear");
+
+    QTest::newRow("linear") << true;
+    QTest::newRow("grid") << false;
+}
+
+void TestShapeIndex::candidatesBenchmark() {
+    QFETCH(bool, linear);
+
+    QVector<QRect> bounds = randomBounds(1000);
+    QVector<QPoint> queries = randomQueries(10000);
+    ShapeIndex index;
+    foreach (QRect rect, bounds)
+        index.append(rect);
+
+    int hits = 0;
+    QBENCHMARK {
+        hits = 0;
+        foreach (QPoint pos, queries) {
+            hits += linear ? linearCandidates(bounds, pos).size()
+                           : index.candidates(pos).size();
+        }
+    }
+    QVERIFY(hits > 0);
+}
+
+QTEST_APPLESS_MAIN(TestShapeIndex)
+
+#include "tst_shapeindex.moc"
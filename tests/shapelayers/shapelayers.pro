@@ -0,0 +1,16 @@
+QT       += core gui testlib
+
+TARGET = tst_shapelayers
+TEMPLATE = app
+
+CONFIG += c++11 testcase console
+CONFIG -= app_bundle
+
+UTILS = $$PWD/../../utils
+INCLUDEPATH += $$UTILS
+
+SOURCES += tst_shapelayers.cpp \
+    $$UTILS/shapelayers.cpp
+
+HEADERS += \
+    $$UTILS/shapelayers.h
@@ -0,0 +1,130 @@
+#include <QtTest>
+#include <QPainter>
+
+#include "shapelayers.h"
+
+namespace {
+const QSize SCREEN_SIZE(400, 300);
+
+/* every shape is a filled rect of its own color, the last drawn one shows
+ * where they overlap */
+QColor shapeColor(int index) {
+    return QColor::fromHsv((index*47) % 360, 255, 255);
+}
+
+QImage blankImage() {
+    QImage img(SCREEN_SIZE, QImage::Format_ARGB32_Premultiplied);
+    img.fill(Qt::white);
+    return img;
+}
+
+/* all shapes in list order, what the saved image must show */
+QImage paintInOrder(const QVector<QRect> &bounds) {
+    QImage img = blankImage();
+    QPainter painter(&img);
+    for (int i = 0; i < bounds.size(); i++)
+        painter.fillRect(bounds[i], shapeColor(i));
+    return img;
+}
+
+/* the way ShapesWidget paints: the cache without the live shapes, then the
+ * live layer over it */
+QImage paintLayers(const QVector<QRect> &bounds, const QVector<int> &liveShapes) {
+    QImage cache(SCREEN_SIZE, QImage::Format_ARGB32_Premultiplied);
+    cache.fill(Qt::transparent);
+    QPainter cachePainter(&cache);
+    for (int i = 0; i < bounds.size(); i++) {
+        if (!liveShapes.contains(i))
+            cachePainter.fillRect(bounds[i], shapeColor(i));
+    }
+    cachePainter.end();
+
+    ShapeLayers layers = splitShapeLayers(bounds, liveShapes,
+                                          QRegion(QRect(QPoint(0, 0), SCREEN_SIZE)));
+    QImage img = blankImage();
+    QPainter painter(&img);
+    foreach (QRect rect, layers.cached.rects())
+        painter.drawImage(rect, cache, rect);
+    painter.setClipRegion(layers.live);
+    foreach (int i, layers.shapes)
+        painter.fillRect(bounds[i], shapeColor(i));
+    return img;
+}
+}
+
+class TestShapeLayers : public QObject {
+    Q_OBJECT
+
+private slots:
+    void selectedStaysBelow();
+    void matchesListOrder_data();
+    void matchesListOrder();
+    void noLiveShapes();
+    void outsideRegion();
+};
+
+void TestShapeLayers::selectedStaysBelow() {
+    QVector<QRect> bounds;
+    bounds << QRect(50, 50, 100, 100) << QRect(100, 100, 100, 100);
+    QVector<int> liveShapes;
+    liveShapes << 0;
+
+    QImage img = paintLayers(bounds, liveShapes);
+    QCOMPARE(img.pixel(125, 125), shapeColor(1).rgb());
+    QCOMPARE(img.pixel(75, 75), shapeColor(0).rgb());
+    QCOMPARE(img, paintInOrder(bounds));
+}
+
+void TestShapeLayers::matchesListOrder_data() {
+    QTest::addColumn<QVector<QRect>>("bounds");
+    QTest::addColumn<QVector<int>>("liveShapes");
+
+    QVector<QRect> stack;
+    stack << QRect(20, 20, 200, 150) << QRect(60, 60, 200, 150)
+          << QRect(100, 100, 200, 150) << QRect(140, 40, 60, 200);
+    QTest::newRow("bottom live") << stack << (QVector<int>() << 0);
+    QTest::newRow("middle live") << stack << (QVector<int>() << 2);
+    QTest::newRow("top live") << stack << (QVector<int>() << 3);
+    QTest::newRow("live around a cached one") << stack << (QVector<int>() << 1 << 3);
+    QTest::newRow("all live") << stack << (QVector<int>() << 0 << 1 << 2 << 3);
+
+    QVector<QRect> apart;
+    apart << QRect(10, 10, 50, 50) << QRect(300, 200, 50, 50) << QRect(40, 40, 50, 50);
+    QTest::newRow("live apart from the others") << apart << (QVector<int>() << 1);
+    QTest::newRow("with an empty shape") << (QVector<QRect>() << QRect() << stack[0] << stack[1])
+                                         << (QVector<int>() << 0 << 1);
+}
+
+void TestShapeLayers::matchesListOrder() {
+    QFETCH(QVector<QRect>, bounds);
+    QFETCH(QVector<int>, liveShapes);
+
+    QCOMPARE(paintLayers(bounds, liveShapes), paintInOrder(bounds));
+}
+
+void TestShapeLayers::noLiveShapes() {
+    QVector<QRect> bounds;
+    bounds << QRect(0, 0, 50, 50) << QRect(20, 20, 50, 50);
+    QRegion region(0, 0, 100, 100);
+
+    ShapeLayers layers = splitShapeLayers(bounds, QVector<int>(), region);
+    QCOMPARE(layers.cached, region);
+    QVERIFY(layers.live.isEmpty());
+    QVERIFY(layers.shapes.isEmpty());
+}
+
+void TestShapeLayers::outsideRegion() {
+    // A live shape away from the repainted region leaves it to the cache.
+    QVector<QRect> bounds;
+    bounds << QRect(0, 0, 50, 50) << QRect(200, 200, 50, 50);
+    QRegion region(180, 180, 100, 100);
+
+    ShapeLayers layers = splitShapeLayers(bounds, QVector<int>() << 0, region);
+    QCOMPARE(layers.cached, region);
+    QVERIFY(layers.live.isEmpty());
+    QVERIFY(layers.shapes.isEmpty());
+}
+
+QTEST_APPLESS_MAIN(TestShapeLayers)
+
+#include "tst_shapelayers.moc"
@@ -6,6 +6,8 @@
 #include <QFile>
 #include <QDebug>
 
+Q_LOGGING_CATEGORY(paintLog, "deepin-screenshot.paint", QtInfoMsg)
+
 QCursor setCursorShape(QString cursorName, int colorIndex) {
     QCursor customShape = QCursor();
     if (cursorName == "start") {
@@ -98,7 +100,8 @@ int colorIndex(QColor color) {
 
 bool          isValidFormat(QString suffix) {
     QStringList validFormat;
-    validFormat << "bmp" << "jpg" << "jpeg" << "png" << "pbm" << "pgm" << "xbm" << "xpm";
+    validFormat << "bmp" << "jpg" << "jpeg" << "png" << "pbm" << "pgm" << "xbm" << "xpm"
+                << "qoi" << "webp";
     if (validFormat.contains(suffix)) {
         return true;
     } else {
@@ -6,6 +6,7 @@
 #include <QLayout>
 #include <QFontMetrics>
 #include <QPainter>
+#include <QLoggingCategory>
 
 enum ResizeDirection {
     Rotate,
@@ -24,10 +25,12 @@ enum ResizeDirection {
 namespace utils {
 const QString TMP_FILE = "/tmp/deepin-screenshot.png";
 const QString TMP_FULLSCREEN_FILE = "/tmp/deepin-screenshot-fullscreen.png";
-const QString TMP_MOSA_FILE = "/tmp/deepin-screenshot-mosa.png";
-const QString TMP_BLUR_FILE = "/tmp/deepin-screenshot-blur.png";
 }
 
+/* per frame repaint and cache statistics, enable them with
+ * QT_LOGGING_RULES="deepin-screenshot.paint.debug=true" */
+Q_DECLARE_LOGGING_CATEGORY(paintLog)
+
 QCursor setCursorShape(QString cursorName, int colorIndex = 0);
 int stringWidth(const QFont &f, const QString &str);
 QString     getFileContent(const QString &file);
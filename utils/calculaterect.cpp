@@ -7,6 +7,7 @@ const int TANT_EDGEVALUE = 0.78539;
 const int TANT2_EDGEVALUE = 2.35619;
 const int MIN_PADDING = 3;
 const qreal SLOPE = 0.5522848;
+const int ELLIPSE_PADDING = 10;
 
 /* judge whether the point1 is on the point2 or not */
 bool pointClickIn(QPointF point2, QPointF point1, int padding) {
@@ -193,6 +194,17 @@ qreal pointToLineDistance(QPointF point1, QPointF point2, QPointF point3) {
     }
 }
 
+qreal pointToSegmentDistance(QPointF point1, QPointF point2, QPointF point3) {
+    QPointF segment = point2 - point1;
+    qreal lengthSquared = QPointF::dotProduct(segment, segment);
+    qreal t = 0;
+    if (lengthSquared > 0) {
+        t = qBound(qreal(0), QPointF::dotProduct(point3 - point1, segment)/lengthSquared,
+                   qreal(1));
+    }
+    return getDistance(point1 + segment*t, point3);
+}
+
 /* judge the direction of point3 of line(point1, point2) */
 qreal pointLineDir(QPointF point1, QPointF point2, QPointF point3) {
     if (point1.x() == point2.x()) {
@@ -248,7 +260,7 @@ QList<QPointF> getEightControlPoint(FourPoints rectFPoints) {
 /* judge whether the clickOnPoint is on the bezier */
 /* 0 <= pos.x() <= 1*/
 bool pointOnBezier(QPointF point1, QPointF point2, QPointF point3, QPointF point4, QPointF pos) {
-    const int MIN_PADDING = 10;
+    const int MIN_PADDING = ELLIPSE_PADDING;
     for (qreal t = 0; t <= 1; t = t + 0.1) {
         qreal bx = point1.x()*(1-t)*std::pow(1-t, 2) + 3*point2.x()*t*std::pow(1-t, 2)
                 + 3*point3.x()*std::pow(t, 2)*(1-t) + point4.x()*t*std::pow(t, 2);
@@ -264,6 +276,55 @@ bool pointOnBezier(QPointF point1, QPointF point2, QPointF point3, QPointF point
 
 /* judge whether the clickOnPoint is on the ellipse */
 bool pointOnEllipse(FourPoints rectFPoints, QPointF pos) {
+    // The half axes run from the center to the midpoints of the right
+    // and bottom edges.
+    QPointF center = (rectFPoints[0] + rectFPoints[3])/2;
+    QPointF xAxis = (rectFPoints[2] + rectFPoints[3])/2 - center;
+    QPointF yAxis = (rectFPoints[1] + rectFPoints[3])/2 - center;
+    qreal a = getDistance(xAxis, QPointF(0, 0));
+    qreal b = getDistance(yAxis, QPointF(0, 0));
+    if (a < 1 || b < 1) {
+        return pointOnEllipseSampled(rectFPoints, pos);
+    }
+
+    // The curve lies in the ring between the two radii.
+    QPointF offset = pos - center;
+    qreal distance = getDistance(offset, QPointF(0, 0));
+    if (distance > std::max(a, b) + ELLIPSE_PADDING
+            || distance < std::min(a, b) - ELLIPSE_PADDING) {
+        return false;
+    }
+
+    // pos in the ellipse frame, folded into the first quadrant.
+    qreal x = std::abs(QPointF::dotProduct(offset, xAxis)/a);
+    qreal y = std::abs(QPointF::dotProduct(offset, yAxis)/b);
+
+    // Walk the nearest point of the curve along its evolute, three steps
+    // bring it well below a pixel for any eccentricity.
+    qreal tx = M_SQRT1_2;
+    qreal ty = M_SQRT1_2;
+    for (int i = 0; i < 3; i++) {
+        qreal ex = (a*a - b*b)*tx*tx*tx/a;
+        qreal ey = (b*b - a*a)*ty*ty*ty/b;
+        qreal rx = a*tx - ex;
+        qreal ry = b*ty - ey;
+        qreal qx = x - ex;
+        qreal qy = y - ey;
+        qreal scale = std::sqrt(rx*rx + ry*ry)/std::max(std::sqrt(qx*qx + qy*qy), qreal(1e-9));
+        qreal nx = qBound(qreal(0), (qx*scale + ex)/a, qreal(1));
+        qreal ny = qBound(qreal(0), (qy*scale + ey)/b, qreal(1));
+        qreal length = std::sqrt(nx*nx + ny*ny);
+        // The center of a circle is as near to any point of it.
+        if (length < 1e-9)
+            break;
+        tx = nx/length;
+        ty = ny/length;
+    }
+
+    return getDistance(QPointF(a*tx, b*ty), QPointF(x, y)) <= ELLIPSE_PADDING;
+}
+
+bool pointOnEllipseSampled(FourPoints rectFPoints, QPointF pos) {
     FourPoints anotherFPoints = getAnotherFPoints(rectFPoints);
     QList<QPointF> controlPointList;
     controlPointList.append(getControlPoint(rectFPoints[0], anotherFPoints[0], true));
@@ -329,6 +390,11 @@ bool pointOnArLine(QList<QPointF> points, QPointF pos) {
     return false;
 }
 
+bool pointOnArLine(const StrokeIndex &stroke, QPointF pos) {
+    // the default padding of pointClickIn
+    return stroke.contains(pos, 4);
+}
+
 /* resize arbitrary curved */
 QList<qreal> relativePosition(FourPoints mainPoints,  QPointF pos) {
     if (mainPoints.length() != 4) {
@@ -4115,3 +4181,36 @@ FourPoints getMainPoints(QPointF point1, QPointF point2, bool isShift) {
 
     return fourPoints;
 }
+
+QPainterPath rectanglePath(FourPoints rectFPoints) {
+    QPainterPath rectPath;
+    rectPath.moveTo(rectFPoints[0].x(), rectFPoints[0].y());
+    rectPath.lineTo(rectFPoints[1].x(),rectFPoints[1].y());
+    rectPath.lineTo(rectFPoints[3].x(),rectFPoints[3].y());
+    rectPath.lineTo(rectFPoints[2].x(),rectFPoints[2].y());
+    rectPath.lineTo(rectFPoints[0].x(),rectFPoints[0].y());
+    return rectPath;
+}
+
+QPainterPath ellipsePath(FourPoints ellipseFPoints) {
+    FourPoints minorPoints = getAnotherFPoints(ellipseFPoints);
+    QList<QPointF> eightControlPoints = getEightControlPoint(ellipseFPoints);
+    QPainterPath ellipsePath;
+    ellipsePath.moveTo(minorPoints[0].x(), minorPoints[0].y());
+    ellipsePath.cubicTo(eightControlPoints[0], eightControlPoints[1], minorPoints[1]);
+    ellipsePath.cubicTo(eightControlPoints[4], eightControlPoints[5], minorPoints[2]);
+    ellipsePath.cubicTo(eightControlPoints[6], eightControlPoints[7], minorPoints[3]);
+    ellipsePath.cubicTo(eightControlPoints[3], eightControlPoints[2], minorPoints[0]);
+    return ellipsePath;
+}
+
+QPainterPath polylinePath(QList<QPointF> points) {
+    QPainterPath path;
+    for (int i = 0; i < points.length(); i++) {
+        if (i == 0)
+            path.moveTo(points[i]);
+        else
+            path.lineTo(points[i]);
+    }
+    return path;
+}
@@ -2,6 +2,7 @@
 #define CALCULATERECT_H
 
 #include <QPointF>
+#include <QPainterPath>
 #include <QtMath>
 #include "shapesutils.h"
 
@@ -44,6 +45,9 @@ QPointF  pointRotate(QPointF point1, QPointF point2, qreal angle);
 /* the distance from a point(point3) to a line(point1, point2) */
 qreal   pointToLineDistance(QPointF point1, QPointF point2, QPointF point3);
 
+/* the distance from a point(point3) to a segment(point1, point2) */
+qreal   pointToSegmentDistance(QPointF point1, QPointF point2, QPointF point3);
+
 /* judge the direction of point3 of line(point1, point2) */
 qreal pointLineDir(QPointF point1, QPointF point2, QPointF point3);
 
@@ -63,6 +67,8 @@ bool pointOnBezier(QPointF point1, QPointF point2, QPointF point3,
 
 /* judge whether the clickOnPoint is on the ellipse */
 bool pointOnEllipse(FourPoints rectFPoints, QPointF pos);
+/* the former test, sampling the four beziers of the drawn outline */
+bool pointOnEllipseSampled(FourPoints rectFPoints, QPointF pos);
 
 /* judge whether the clickOnPoint is in the ellipse*/
 
@@ -71,6 +77,7 @@ QList<QPointF> pointOfArrow(QPointF startPoint, QPointF endPoint, qreal arrowLen
 
 /* judge whether the pos is on the points*/
 bool pointOnArLine(QList<QPointF> points, QPointF pos);
+bool pointOnArLine(const StrokeIndex &stroke, QPointF pos);
 
 /* resize arbitrary curved */
 QList<qreal> relativePosition(FourPoints mainPoints, QPointF pos);
@@ -276,4 +283,9 @@ FourPoints point8ResizeMicro(FourPoints fourPoints,  bool isBig);
 /***********************  special process   ***************************/
 bool pointInRect(FourPoints fourPoints, QPointF pos);
 FourPoints getMainPoints(QPointF point1, QPointF point2, bool isShift= false);
+
+/* outlines of the shapes, a polyline path has one element per point */
+QPainterPath rectanglePath(FourPoints rectFPoints);
+QPainterPath ellipsePath(FourPoints ellipseFPoints);
+QPainterPath polylinePath(QList<QPointF> points);
 #endif // CALCULATERECT_H
@@ -23,6 +23,7 @@ ConfigSettings::ConfigSettings(QObject *parent)
         setValue("oval", "linewidth_index", 1);
         setValue("line", "color_index", 3);
         setValue("line", "linewidth_index", 1);
+        setValue("line", "smooth", false);
         setValue("rectangle", "color_index", 3);
         setValue("rectangle", "linewidth_index", 1);
         setValue("text", "color_index", 3);
@@ -30,10 +31,21 @@ ConfigSettings::ConfigSettings(QObject *parent)
 
         setValue("save", "save_op", 0);
         setValue("save", "save_quality", 100);
+        setValue("save", "png_level", 6);
+        setValue("save", "format", "png");
+
+        setValue("capture", "frozen_frame", true);
+
+        setValue("zoom", "scale", 4);
+        setValue("zoom", "patch_size", 12);
+
+        setValue("effect", "blur_radius", 10);
+        setValue("effect", "mosaic_cell_size", 10);
+        setValue("effect", "redact_color", "#000000");
+        setValue("effect", "highlight_color", "#ffe24d");
     }
 
-    setValue("effect", "is_blur", false);
-    setValue("effect", "is_mosaic", false);
+    setValue("effect", "current", "");
 
     qDebug() << "Setting file:" << m_settings->fileName();
 }
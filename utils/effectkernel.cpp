@@ -0,0 +1,144 @@
+#include "effectkernel.h"
+#include "imagefilters.h"
+#include "configsettings.h"
+
+#include <QColor>
+#include <QMap>
+
+namespace {
+class BlurKernel : public EffectKernel {
+public:
+    BlurKernel() {
+        m_radius = qMax(1, ConfigSettings::instance()->value(
+                            "effect", "blur_radius", 10).toInt());
+    }
+
+    QString name() const Q_DECL_OVERRIDE { return "blur"; }
+    QString key() const Q_DECL_OVERRIDE { return QString("blur/%1").arg(m_radius); }
+    int margin() const Q_DECL_OVERRIDE { return blurMargin(m_radius); }
+    QString sizeKey() const Q_DECL_OVERRIDE { return "blur_radius"; }
+    bool isExpensive() const Q_DECL_OVERRIDE { return true; }
+    QImage apply(const QImage &img) const Q_DECL_OVERRIDE {
+        return blurImage(img, m_radius);
+    }
+
+private:
+    int m_radius;
+};
+
+class MosaicKernel : public EffectKernel {
+public:
+    MosaicKernel() {
+        m_cellSize = qMax(2, ConfigSettings::instance()->value(
+                              "effect", "mosaic_cell_size", 10).toInt());
+    }
+
+    QString name() const Q_DECL_OVERRIDE { return "mosaic"; }
+    QString key() const Q_DECL_OVERRIDE { return QString("mosaic/%1").arg(m_cellSize); }
+    // Cells never cross a tile, so cells stay on the selection's grid.
+    int alignment() const Q_DECL_OVERRIDE { return m_cellSize; }
+    QString sizeKey() const Q_DECL_OVERRIDE { return "mosaic_cell_size"; }
+    bool isExpensive() const Q_DECL_OVERRIDE { return true; }
+    QImage apply(const QImage &img) const Q_DECL_OVERRIDE {
+        return pixelateImage(img, m_cellSize);
+    }
+
+private:
+    int m_cellSize;
+};
+
+/* Opaque fill, nothing of the covered pixels survives. */
+class RedactKernel : public EffectKernel {
+public:
+    RedactKernel() {
+        m_color = QColor(ConfigSettings::instance()->value(
+                             "effect", "redact_color", "#000000").toString());
+    }
+
+    QString name() const Q_DECL_OVERRIDE { return "redact"; }
+    QString key() const Q_DECL_OVERRIDE { return "redact/" + m_color.name(); }
+    QImage apply(const QImage &img) const Q_DECL_OVERRIDE {
+        QImage filled(img.size(), QImage::Format_RGB32);
+        filled.fill(m_color.rgb());
+        return filled;
+    }
+
+private:
+    QColor m_color;
+};
+
+/* Highlighter pen, the pixels are multiplied with the color. */
+class HighlightKernel : public EffectKernel {
+public:
+    HighlightKernel() {
+        m_color = QColor(ConfigSettings::instance()->value(
+                             "effect", "highlight_color", "#ffe24d").toString());
+    }
+
+    QString name() const Q_DECL_OVERRIDE { return "highlight"; }
+    QString key() const Q_DECL_OVERRIDE { return "highlight/" + m_color.name(); }
+    QImage apply(const QImage &img) const Q_DECL_OVERRIDE {
+        return multiplyImage(img, m_color.rgb());
+    }
+
+private:
+    QColor m_color;
+};
+
+struct KernelRegistry {
+    QStringList names;
+    QMap<QString, EffectKernel::Factory> factories;
+};
+
+KernelRegistry &registry() {
+    static KernelRegistry kernels;
+    if (kernels.names.isEmpty()) {
+        kernels.names << "blur" << "mosaic" << "redact" << "highlight";
+        kernels.factories.insert("blur", [] { return new BlurKernel(); });
+        kernels.factories.insert("mosaic", [] { return new MosaicKernel(); });
+        kernels.factories.insert("redact", [] { return new RedactKernel(); });
+        kernels.factories.insert("highlight", [] { return new HighlightKernel(); });
+    }
+
+    return kernels;
+}
+}
+
+QSharedPointer<const EffectKernel> EffectKernel::create(const QString &name) {
+    EffectKernel::Factory factory = registry().factories.value(name);
+    if (!factory)
+        return QSharedPointer<const EffectKernel>();
+
+    return QSharedPointer<const EffectKernel>(factory());
+}
+
+void EffectKernel::registerKernel(const QString &name, const Factory &factory) {
+    KernelRegistry &kernels = registry();
+    if (!kernels.names.contains(name))
+        kernels.names.append(name);
+    kernels.factories.insert(name, factory);
+}
+
+QStringList EffectKernel::names() {
+    return registry().names;
+}
+
+QString EffectKernel::key() const {
+    return name();
+}
+
+int EffectKernel::margin() const {
+    return 0;
+}
+
+int EffectKernel::alignment() const {
+    return 1;
+}
+
+QString EffectKernel::sizeKey() const {
+    return QString();
+}
+
+bool EffectKernel::isExpensive() const {
+    return false;
+}
@@ -0,0 +1,39 @@
+#ifndef EFFECTKERNEL_H
+#define EFFECTKERNEL_H
+
+#include <QImage>
+#include <QSharedPointer>
+#include <QStringList>
+
+#include <functional>
+
+/* An effect which blur, mosaic... shapes paint with. A kernel is applied
+ * to tiles of the selection from several threads at once, so apply()
+ * must not touch anything but its arguments. */
+class EffectKernel {
+public:
+    typedef std::function<EffectKernel*()> Factory;
+
+    virtual ~EffectKernel() {}
+
+    /* the kernel with the current settings of the named effect */
+    static QSharedPointer<const EffectKernel> create(const QString &name);
+    static void registerKernel(const QString &name, const Factory &factory);
+    static QStringList names();
+
+    virtual QString name() const = 0;
+    /* identifies the output, layers are cached by it */
+    virtual QString key() const;
+    /* how far apply() reads around a pixel, tiles are filtered with
+     * this margin so they join seamlessly */
+    virtual int margin() const;
+    /* tiles are a multiple of it, for kernels which work on cells */
+    virtual int alignment() const;
+    /* the "effect" config key of the size setting, if any */
+    virtual QString sizeKey() const;
+    /* worth computing before any shape asks for it */
+    virtual bool isExpensive() const;
+    virtual QImage apply(const QImage &img) const = 0;
+};
+
+#endif // EFFECTKERNEL_H
@@ -0,0 +1,136 @@
+#include "effectlayer.h"
+#include "parallel.h"
+#include "baseutils.h"
+
+#include <QPainter>
+#include <QElapsedTimer>
+#include <QVector>
+#include <QDebug>
+
+namespace {
+const int TILE_SIZE = 128;
+
+quint64 tileKey(int column, int row) {
+    return (quint64(quint32(row)) << 32) | quint32(column);
+}
+}
+
+EffectLayer::EffectLayer() {
+}
+
+EffectLayer::EffectLayer(const QImage &source, const QPoint &origin,
+                         const QSharedPointer<const EffectKernel> &kernel)
+    : d(new LayerData) {
+    d->source = source;
+    d->origin = origin;
+    d->kernel = kernel;
+    const int alignment = kernel ? qMax(1, kernel->alignment()) : 1;
+    d->tileSize = alignment*qMax(1, TILE_SIZE/alignment);
+}
+
+bool EffectLayer::isNull() const {
+    return !d || d->source.isNull() || !d->kernel;
+}
+
+int EffectLayer::tileCount() const {
+    if (!d)
+        return 0;
+
+    QMutexLocker locker(&d->mutex);
+    return d->tiles.count();
+}
+
+QRect EffectLayer::tileRect(int column, int row) const {
+    return QRect(column*d->tileSize, row*d->tileSize, d->tileSize, d->tileSize)
+            .intersected(d->source.rect());
+}
+
+QImage EffectLayer::computeTile(const QRect &tileRect) const {
+    // Filter the tile together with its margin, the source edges are
+    // clamped the same way as when the whole source is filtered.
+    const int margin = d->kernel->margin();
+    QRect readRect = tileRect.adjusted(-margin, -margin, margin, margin)
+            .intersected(d->source.rect());
+    QImage filtered = d->kernel->apply(d->source.copy(readRect));
+    return filtered.copy(tileRect.translated(-readRect.topLeft()));
+}
+
+void EffectLayer::ensureTiles(const QRect &sourceRect) {
+    const int left = sourceRect.left()/d->tileSize;
+    const int right = sourceRect.right()/d->tileSize;
+    const int top = sourceRect.top()/d->tileSize;
+    const int bottom = sourceRect.bottom()/d->tileSize;
+
+    QVector<QPoint> missing;
+    {
+        QMutexLocker locker(&d->mutex);
+        for (int row = top; row <= bottom; row++) {
+            for (int column = left; column <= right; column++) {
+                if (!d->tiles.contains(tileKey(column, row)))
+                    missing.append(QPoint(column, row));
+            }
+        }
+    }
+    if (missing.isEmpty())
+        return;
+
+    QElapsedTimer timer;
+    timer.start();
+    QVector<QImage> tiles(missing.count());
+    parallelFor(missing.count(), [&](int index) {
+        tiles[index] = computeTile(tileRect(missing[index].x(), missing[index].y()));
+    });
+
+    QMutexLocker locker(&d->mutex);
+    for (int i = 0; i < missing.count(); i++) {
+        d->tiles.insert(tileKey(missing[i].x(), missing[i].y()), tiles[i]);
+    }
+    qCDebug(paintLog) << "effect tiles:" << missing.count() << "cached:" << d->tiles.count()
+                      << timer.elapsed() << "ms";
+}
+
+void EffectLayer::computeAll(const QAtomicInt &cancelled) {
+    if (isNull())
+        return;
+
+    const int columns = (d->source.width() + d->tileSize - 1)/d->tileSize;
+    const int rows = (d->source.height() + d->tileSize - 1)/d->tileSize;
+    for (int row = 0; row < rows; row++) {
+        for (int column = 0; column < columns; column++) {
+            if (cancelled.load())
+                return;
+
+            {
+                QMutexLocker locker(&d->mutex);
+                if (d->tiles.contains(tileKey(column, row)))
+                    continue;
+            }
+            // A tile painted meanwhile is simply computed twice.
+            QImage tile = computeTile(tileRect(column, row));
+            QMutexLocker locker(&d->mutex);
+            d->tiles.insert(tileKey(column, row), tile);
+        }
+    }
+}
+
+void EffectLayer::draw(QPainter &painter, const QRect &rect) {
+    if (isNull())
+        return;
+
+    QRect sourceRect = rect.translated(d->origin).intersected(d->source.rect());
+    if (sourceRect.isEmpty())
+        return;
+
+    ensureTiles(sourceRect);
+    QMutexLocker locker(&d->mutex);
+    for (int row = sourceRect.top()/d->tileSize; row <= sourceRect.bottom()/d->tileSize; row++) {
+        for (int column = sourceRect.left()/d->tileSize;
+             column <= sourceRect.right()/d->tileSize; column++) {
+            QRect tile = tileRect(column, row);
+            QRect blitRect = tile.intersected(sourceRect);
+            painter.drawImage(blitRect.translated(-d->origin),
+                              d->tiles.value(tileKey(column, row)),
+                              blitRect.translated(-tile.topLeft()));
+        }
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef EFFECTLAYER_H
+#define EFFECTLAYER_H
+
+#include <QImage>
+#include <QHash>
+#include <QRect>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QSharedPointer>
+
+#include "effectkernel.h"
+
+class QPainter;
+
+/* An effect kernel's layer over the selection, computed lazily in square
+ * tiles, so only the tiles under an effect shape are ever filtered and
+ * moving a shape only computes the tiles it newly touches. Copies share
+ * one tile cache, which may be filled from a worker thread. */
+class EffectLayer {
+public:
+    EffectLayer();
+    /* origin is the position of the widget's (0, 0) in source */
+    EffectLayer(const QImage &source, const QPoint &origin,
+                const QSharedPointer<const EffectKernel> &kernel);
+
+    bool isNull() const;
+    /* draw the layer over rect, in widget coordinates */
+    void draw(QPainter &painter, const QRect &rect);
+    /* compute every missing tile, one at a time, until cancelled */
+    void computeAll(const QAtomicInt &cancelled);
+    int tileCount() const;
+
+private:
+    struct LayerData {
+        QImage source;
+        QPoint origin;
+        int tileSize;
+        QSharedPointer<const EffectKernel> kernel;
+        QMutex mutex;
+        QHash<quint64, QImage> tiles;
+    };
+
+    void ensureTiles(const QRect &sourceRect);
+    QImage computeTile(const QRect &tileRect) const;
+    QRect tileRect(int column, int row) const;
+
+    QSharedPointer<LayerData> d;
+};
+
+#endif // EFFECTLAYER_H
@@ -0,0 +1,41 @@
+#include "effectprecomputer.h"
+#include "parallel.h"
+#include "baseutils.h"
+
+#include <QElapsedTimer>
+#include <QDebug>
+
+EffectPrecomputer::EffectPrecomputer(QObject *parent)
+    : QThread(parent) {
+}
+
+void EffectPrecomputer::precompute(const QList<EffectLayer> &layers) {
+    cancel();
+
+    m_layers = layers;
+    m_cancelled.store(0);
+    start(QThread::LowestPriority);
+}
+
+void EffectPrecomputer::cancel() {
+    m_cancelled.store(1);
+    wait();
+}
+
+void EffectPrecomputer::run() {
+    // The pool threads run at normal priority on every core, the
+    // kernels stay on this thread so they don't compete with the UI.
+    SerialScope serial;
+    QElapsedTimer timer;
+    timer.start();
+    foreach (EffectLayer layer, m_layers) {
+        layer.computeAll(m_cancelled);
+    }
+
+    qCDebug(paintLog) << "effect precompute" << (m_cancelled.load() ? "cancelled" : "done")
+                      << timer.elapsed() << "ms";
+}
+
+EffectPrecomputer::~EffectPrecomputer() {
+    cancel();
+}
@@ -0,0 +1,31 @@
+#ifndef EFFECTPRECOMPUTER_H
+#define EFFECTPRECOMPUTER_H
+
+#include <QThread>
+#include <QList>
+#include <QAtomicInt>
+
+#include "effectlayer.h"
+
+/* Fill effect layers on a single low priority thread while the user is
+ * still looking at the selection, so the first blur or mosaic shape
+ * finds its tiles already computed. */
+class EffectPrecomputer : public QThread {
+    Q_OBJECT
+public:
+    EffectPrecomputer(QObject* parent = 0);
+    ~EffectPrecomputer();
+
+    /* cancel the running pass and start over with layers */
+    void precompute(const QList<EffectLayer> &layers);
+    /* stop after the current tile and wait for the thread */
+    void cancel();
+
+protected:
+    void run() Q_DECL_OVERRIDE;
+
+private:
+    QList<EffectLayer> m_layers;
+    QAtomicInt m_cancelled;
+};
+#endif // EFFECTPRECOMPUTER_H
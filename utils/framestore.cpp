@@ -0,0 +1,86 @@
+#include "framestore.h"
+#include "configsettings.h"
+
+#include <QDebug>
+
+namespace {
+void releaseFrameRef(void *info) {
+    delete static_cast<QImage*>(info);
+}
+}
+
+FrameStore::FrameStore(QObject *parent)
+    : QObject(parent) {
+}
+
+FrameStore* FrameStore::m_frameStore = nullptr;
+FrameStore* FrameStore::instance() {
+    if (!m_frameStore) {
+        m_frameStore = new FrameStore();
+    }
+
+    return m_frameStore;
+}
+
+void FrameStore::setFrame(const QImage &frame) {
+    {
+        QMutexLocker locker(&m_mutex);
+        m_frame = frame;
+    }
+
+    emit frameChanged();
+}
+
+QImage FrameStore::frame() {
+    QMutexLocker locker(&m_mutex);
+    return m_frame;
+}
+
+QImage FrameStore::region(const QRect &rect) {
+    QMutexLocker locker(&m_mutex);
+
+    QRect validRect = rect.intersected(m_frame.rect());
+    if (validRect.isEmpty()) {
+        return QImage();
+    }
+
+    if (validRect == m_frame.rect()) {
+        return m_frame;
+    }
+
+    const int depth = m_frame.depth() / 8;
+    const uchar* bits = m_frame.constScanLine(validRect.y()) + validRect.x()*depth;
+
+    // The view holds its own reference of the frame, so the pixels
+    // are released only when the last view goes away.
+    QImage view(bits, validRect.width(), validRect.height(),
+                m_frame.bytesPerLine(), m_frame.format(),
+                releaseFrameRef, new QImage(m_frame));
+    view.setDevicePixelRatio(m_frame.devicePixelRatio());
+    return view;
+}
+
+bool FrameStore::isEmpty() {
+    QMutexLocker locker(&m_mutex);
+    return m_frame.isNull();
+}
+
+void FrameStore::clear() {
+    QMutexLocker locker(&m_mutex);
+    m_frame = QImage();
+}
+
+bool FrameStore::dumpEnabled() {
+    return ConfigSettings::instance()->value("debug", "dump_tmp_files", false).toBool();
+}
+
+void FrameStore::dumpImage(const QImage &img, const QString &path) {
+    if (!dumpEnabled() || img.isNull())
+        return;
+
+    qDebug() << "dump image:" << path << img.size();
+    img.save(path, "png");
+}
+
+FrameStore::~FrameStore() {
+}
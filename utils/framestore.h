@@ -0,0 +1,38 @@
+#ifndef FRAMESTORE_H
+#define FRAMESTORE_H
+
+#include <QObject>
+#include <QImage>
+#include <QMutex>
+
+/* Keep the captured screen frame in memory, every stage of the capture
+ * pipeline reads from here instead of decoding a png from /tmp. */
+class FrameStore : public QObject {
+    Q_OBJECT
+public:
+    static FrameStore *instance();
+
+    void setFrame(const QImage &frame);
+    QImage frame();
+    /* a cropped view which shares pixels with the frame, it stays
+     * valid even if the frame is replaced later */
+    QImage region(const QRect &rect);
+    bool isEmpty();
+    void clear();
+
+    /* only write temp files when the debug option asks for them */
+    static bool dumpEnabled();
+    static void dumpImage(const QImage &img, const QString &path);
+
+signals:
+    void frameChanged();
+
+private:
+    FrameStore(QObject* parent = 0);
+    ~FrameStore();
+
+    static FrameStore* m_frameStore;
+    QImage m_frame;
+    QMutex m_mutex;
+};
+#endif // FRAMESTORE_H
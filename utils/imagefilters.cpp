@@ -0,0 +1,619 @@
+#include "imagefilters.h"
+#include "parallel.h"
+
+#include <QHash>
+#include <QVector>
+#include <QDebug>
+
+#include <algorithm>
+#include <cmath>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define HAS_AVX2_TARGET
+#endif
+
+namespace {
+const int HIST_BITS = 5;
+const int HIST_SIDE = 1 << HIST_BITS;
+const int HIST_SIZE = HIST_SIDE*HIST_SIDE*HIST_SIDE;
+
+inline int histIndex(int r, int g, int b) {
+    return (r << (2*HIST_BITS)) | (g << HIST_BITS) | b;
+}
+
+inline int histIndex(QRgb px) {
+    return histIndex(qRed(px) >> 3, qGreen(px) >> 3, qBlue(px) >> 3);
+}
+
+struct HistBin {
+    quint64 count = 0;
+    quint64 r = 0;
+    quint64 g = 0;
+    quint64 b = 0;
+};
+
+struct ColorBox {
+    int min[3];
+    int max[3];
+    quint64 count;
+};
+
+quint64 binCount(const QVector<HistBin> &hist, int c0, int c1, int c2, int axis) {
+    int rgb[3];
+    rgb[axis] = c0;
+    rgb[(axis + 1) % 3] = c1;
+    rgb[(axis + 2) % 3] = c2;
+    return hist[histIndex(rgb[0], rgb[1], rgb[2])].count;
+}
+
+/* shrink the box to the bins which hold pixels */
+void shrinkBox(const QVector<HistBin> &hist, ColorBox &box) {
+    int newMin[3] = {HIST_SIDE, HIST_SIDE, HIST_SIDE};
+    int newMax[3] = {-1, -1, -1};
+    box.count = 0;
+    for (int r = box.min[0]; r <= box.max[0]; r++) {
+        for (int g = box.min[1]; g <= box.max[1]; g++) {
+            for (int b = box.min[2]; b <= box.max[2]; b++) {
+                quint64 count = hist[histIndex(r, g, b)].count;
+                if (count == 0)
+                    continue;
+
+                box.count += count;
+                newMin[0] = std::min(newMin[0], r);
+                newMin[1] = std::min(newMin[1], g);
+                newMin[2] = std::min(newMin[2], b);
+                newMax[0] = std::max(newMax[0], r);
+                newMax[1] = std::max(newMax[1], g);
+                newMax[2] = std::max(newMax[2], b);
+            }
+        }
+    }
+
+    if (box.count > 0) {
+        std::copy(newMin, newMin + 3, box.min);
+        std::copy(newMax, newMax + 3, box.max);
+    }
+}
+
+/* split on the longest axis at the population median */
+bool splitBox(const QVector<HistBin> &hist, ColorBox &box, ColorBox &other) {
+    int axis = 0;
+    for (int i = 1; i < 3; i++) {
+        if (box.max[i] - box.min[i] > box.max[axis] - box.min[axis])
+            axis = i;
+    }
+    if (box.max[axis] == box.min[axis])
+        return false;
+
+    const int a1 = (axis + 1) % 3;
+    const int a2 = (axis + 2) % 3;
+    quint64 sum = 0;
+    int cut = box.min[axis];
+    for (; cut < box.max[axis]; cut++) {
+        for (int c1 = box.min[a1]; c1 <= box.max[a1]; c1++) {
+            for (int c2 = box.min[a2]; c2 <= box.max[a2]; c2++) {
+                sum += binCount(hist, cut, c1, c2, axis);
+            }
+        }
+        if (sum*2 >= box.count)
+            break;
+    }
+    cut = std::min(cut, box.max[axis] - 1);
+
+    other = box;
+    box.max[axis] = cut;
+    other.min[axis] = cut + 1;
+    shrinkBox(hist, box);
+    shrinkBox(hist, other);
+
+    return true;
+}
+
+template <typename Lookup>
+QImage mapToPalette(const QImage &srcImg, const QVector<QRgb> &palette, Lookup lookup) {
+    QImage result(srcImg.size(), QImage::Format_Indexed8);
+    result.setColorTable(palette);
+    for (int y = 0; y < srcImg.height(); y++) {
+        const QRgb* src = reinterpret_cast<const QRgb*>(srcImg.constScanLine(y));
+        uchar* dst = result.scanLine(y);
+        for (int x = 0; x < srcImg.width(); x++) {
+            dst[x] = lookup(src[x] | 0xff000000);
+        }
+    }
+
+    return result;
+}
+}
+
+QImage quantizeImage(const QImage &img, int maxColors) {
+    if (img.isNull())
+        return img;
+
+    maxColors = qBound(2, maxColors, 256);
+    QImage srcImg = img.convertToFormat(QImage::Format_RGB32);
+
+    // Screenshots of flat UIs often fit in the palette without loss.
+    QHash<QRgb, uchar> exactColors;
+    QVector<QRgb> palette;
+    bool exact = true;
+    QVector<HistBin> hist(HIST_SIZE);
+    for (int y = 0; y < srcImg.height(); y++) {
+        const QRgb* src = reinterpret_cast<const QRgb*>(srcImg.constScanLine(y));
+        for (int x = 0; x < srcImg.width(); x++) {
+            QRgb px = src[x] | 0xff000000;
+            if (exact && !exactColors.contains(px)) {
+                if (palette.size() < maxColors) {
+                    exactColors.insert(px, palette.size());
+                    palette.append(px);
+                } else {
+                    exact = false;
+                }
+            }
+
+            HistBin &bin = hist[histIndex(px)];
+            bin.count++;
+            bin.r += qRed(px);
+            bin.g += qGreen(px);
+            bin.b += qBlue(px);
+        }
+    }
+
+    if (exact) {
+        return mapToPalette(srcImg, palette, [&](QRgb px) {
+            return exactColors.value(px);
+        });
+    }
+
+    QVector<ColorBox> boxes;
+    ColorBox whole;
+    for (int i = 0; i < 3; i++) {
+        whole.min[i] = 0;
+        whole.max[i] = HIST_SIDE - 1;
+    }
+    shrinkBox(hist, whole);
+    boxes.append(whole);
+
+    while (boxes.size() < maxColors) {
+        int target = -1;
+        for (int i = 0; i < boxes.size(); i++) {
+            const ColorBox &box = boxes[i];
+            if (box.min[0] == box.max[0] && box.min[1] == box.max[1]
+                    && box.min[2] == box.max[2])
+                continue;
+            if (target == -1 || box.count > boxes[target].count)
+                target = i;
+        }
+        if (target == -1)
+            break;
+
+        ColorBox other;
+        if (!splitBox(hist, boxes[target], other))
+            break;
+        boxes.append(other);
+    }
+
+    QVector<uchar> lut(HIST_SIZE, 0);
+    palette.clear();
+    for (int i = 0; i < boxes.size(); i++) {
+        const ColorBox &box = boxes[i];
+        quint64 r = 0, g = 0, b = 0, count = 0;
+        for (int rr = box.min[0]; rr <= box.max[0]; rr++) {
+            for (int gg = box.min[1]; gg <= box.max[1]; gg++) {
+                for (int bb = box.min[2]; bb <= box.max[2]; bb++) {
+                    const int index = histIndex(rr, gg, bb);
+                    const HistBin &bin = hist[index];
+                    lut[index] = i;
+                    r += bin.r;
+                    g += bin.g;
+                    b += bin.b;
+                    count += bin.count;
+                }
+            }
+        }
+
+        count = std::max<quint64>(count, 1);
+        palette.append(qRgb(r/count, g/count, b/count));
+    }
+
+    return mapToPalette(srcImg, palette, [&](QRgb px) {
+        return lut[histIndex(px)];
+    });
+}
+
+namespace {
+const int BLUR_BAND_ROWS = 64;
+const int BLUR_STRIP_PIXELS = 256;
+
+/* Box widths whose three passes approximate a gaussian of sigma. */
+void boxesForGauss(qreal sigma, int radii[3]) {
+    const int passes = 3;
+    qreal idealWidth = std::sqrt(12*sigma*sigma/passes + 1);
+    int lower = std::floor(idealWidth);
+    if (lower % 2 == 0)
+        lower--;
+    const int upper = lower + 2;
+
+    qreal idealCount = (12*sigma*sigma - passes*lower*lower - 4*passes*lower - 3*passes)
+            / (-4*lower - 4);
+    const int count = qRound(idealCount);
+    for (int i = 0; i < passes; i++) {
+        radii[i] = ((i < count ? lower : upper) - 1)/2;
+    }
+}
+
+/* Horizontal box pass over one row, the edge pixels are repeated. */
+void boxBlurRow(const quint32* src, quint32* dst, int width, int radius) {
+    const float inv = 1.0f/(radius*2 + 1);
+#ifdef __SSE2__
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 scale = _mm_set1_ps(inv);
+    const __m128 half = _mm_set1_ps(0.5f);
+    auto unpack = [&](quint32 px) {
+        __m128i v = _mm_cvtsi32_si128(px);
+        return _mm_unpacklo_epi16(_mm_unpacklo_epi8(v, zero), zero);
+    };
+
+    __m128i sum = zero;
+    for (int i = -radius; i <= radius; i++) {
+        sum = _mm_add_epi32(sum, unpack(src[qBound(0, i, width - 1)]));
+    }
+
+    for (int x = 0; x < width; x++) {
+        __m128i out = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(sum), scale), half));
+        out = _mm_packs_epi32(out, out);
+        dst[x] = _mm_cvtsi128_si32(_mm_packus_epi16(out, out));
+
+        sum = _mm_add_epi32(sum, unpack(src[std::min(x + radius + 1, width - 1)]));
+        sum = _mm_sub_epi32(sum, unpack(src[std::max(x - radius, 0)]));
+    }
+#else
+    quint32 sum[4] = {0, 0, 0, 0};
+    for (int c = 0; c < 4; c++) {
+        for (int i = -radius; i <= radius; i++) {
+            sum[c] += (src[qBound(0, i, width - 1)] >> (c*8)) & 0xff;
+        }
+    }
+
+    for (int x = 0; x < width; x++) {
+        quint32 px = 0;
+        const quint32 addPx = src[std::min(x + radius + 1, width - 1)];
+        const quint32 subPx = src[std::max(x - radius, 0)];
+        for (int c = 0; c < 4; c++) {
+            px |= quint32(sum[c]*inv + 0.5f) << (c*8);
+            sum[c] += ((addPx >> (c*8)) & 0xff) - ((subPx >> (c*8)) & 0xff);
+        }
+        dst[x] = px;
+    }
+#endif
+}
+
+/* One output row of the vertical pass, sums holds the window of every
+ * byte of the strip and slides down by one row. */
+void boxBlurSpan(const uchar* addRow, const uchar* subRow, quint32* sums,
+                 uchar* dst, int bytes, float inv) {
+    int i = 0;
+#ifdef __SSE2__
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 scale = _mm_set1_ps(inv);
+    const __m128 half = _mm_set1_ps(0.5f);
+    for (; i + 16 <= bytes; i += 16) {
+        __m128i out[4];
+        for (int k = 0; k < 4; k++) {
+            __m128 sum = _mm_cvtepi32_ps(_mm_loadu_si128(
+                                             reinterpret_cast<const __m128i*>(sums + i + k*4)));
+            out[k] = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(sum, scale), half));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                         _mm_packus_epi16(_mm_packs_epi32(out[0], out[1]),
+                                          _mm_packs_epi32(out[2], out[3])));
+
+        __m128i add = _mm_loadu_si128(reinterpret_cast<const __m128i*>(addRow + i));
+        __m128i sub = _mm_loadu_si128(reinterpret_cast<const __m128i*>(subRow + i));
+        __m128i add16[2] = {_mm_unpacklo_epi8(add, zero), _mm_unpackhi_epi8(add, zero)};
+        __m128i sub16[2] = {_mm_unpacklo_epi8(sub, zero), _mm_unpackhi_epi8(sub, zero)};
+        for (int k = 0; k < 4; k++) {
+            __m128i* sumPtr = reinterpret_cast<__m128i*>(sums + i + k*4);
+            __m128i delta = (k % 2 == 0)
+                    ? _mm_sub_epi32(_mm_unpacklo_epi16(add16[k/2], zero),
+                                    _mm_unpacklo_epi16(sub16[k/2], zero))
+                    : _mm_sub_epi32(_mm_unpackhi_epi16(add16[k/2], zero),
+                                    _mm_unpackhi_epi16(sub16[k/2], zero));
+            _mm_storeu_si128(sumPtr, _mm_add_epi32(_mm_loadu_si128(sumPtr), delta));
+        }
+    }
+#endif
+    for (; i < bytes; i++) {
+        dst[i] = uchar(sums[i]*inv + 0.5f);
+        sums[i] += addRow[i] - subRow[i];
+    }
+}
+
+#ifdef HAS_AVX2_TARGET
+__attribute__((target("avx2")))
+void boxBlurSpanAvx2(const uchar* addRow, const uchar* subRow, quint32* sums,
+                     uchar* dst, int bytes, float inv) {
+    const __m256 scale = _mm256_set1_ps(inv);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    // packs and packus work per 128 bit lane, this puts the dwords back
+    // in memory order.
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    int i = 0;
+    for (; i + 32 <= bytes; i += 32) {
+        __m256i out[4];
+        for (int k = 0; k < 4; k++) {
+            __m256 sum = _mm256_cvtepi32_ps(_mm256_loadu_si256(
+                                                reinterpret_cast<const __m256i*>(sums + i + k*8)));
+            out[k] = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(sum, scale), half));
+        }
+        __m256i packed = _mm256_packus_epi16(_mm256_packs_epi32(out[0], out[1]),
+                                             _mm256_packs_epi32(out[2], out[3]));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i),
+                            _mm256_permutevar8x32_epi32(packed, order));
+
+        for (int k = 0; k < 4; k++) {
+            __m256i add = _mm256_cvtepu8_epi32(_mm_loadl_epi64(
+                                                   reinterpret_cast<const __m128i*>(addRow + i + k*8)));
+            __m256i sub = _mm256_cvtepu8_epi32(_mm_loadl_epi64(
+                                                   reinterpret_cast<const __m128i*>(subRow + i + k*8)));
+            __m256i* sumPtr = reinterpret_cast<__m256i*>(sums + i + k*8);
+            _mm256_storeu_si256(sumPtr, _mm256_add_epi32(_mm256_loadu_si256(sumPtr),
+                                                         _mm256_sub_epi32(add, sub)));
+        }
+    }
+
+    boxBlurSpan(addRow + i, subRow + i, sums + i, dst + i, bytes - i, inv);
+}
+#endif
+
+typedef void (*BoxBlurSpanFunc)(const uchar*, const uchar*, quint32*, uchar*, int, float);
+
+BoxBlurSpanFunc boxBlurSpanFunc() {
+#ifdef HAS_AVX2_TARGET
+    static const bool hasAvx2 = __builtin_cpu_supports("avx2");
+    if (hasAvx2)
+        return boxBlurSpanAvx2;
+#endif
+    return boxBlurSpan;
+}
+
+/* Vertical box pass over the columns [left, right), src and dst are
+ * raw pixels since QImage::scanLine() isn't safe to call from several
+ * threads. */
+void boxBlurColumns(const uchar* src, uchar* dst, int bytesPerLine, int height,
+                    int left, int right, int radius) {
+    const int bytes = (right - left)*4;
+    const float inv = 1.0f/(radius*2 + 1);
+    const BoxBlurSpanFunc span = boxBlurSpanFunc();
+    auto row = [&](const uchar* bits, int y) {
+        return bits + qBound(0, y, height - 1)*bytesPerLine + left*4;
+    };
+
+    QVector<quint32> sums(bytes, 0);
+    for (int y = -radius; y <= radius; y++) {
+        const uchar* line = row(src, y);
+        for (int i = 0; i < bytes; i++) {
+            sums[i] += line[i];
+        }
+    }
+
+    for (int y = 0; y < height; y++) {
+        span(row(src, y + radius + 1), row(src, y - radius), sums.data(),
+             dst + y*bytesPerLine + left*4, bytes, inv);
+    }
+}
+}
+
+QImage blurImage(const QImage &img, int radius) {
+    if (img.isNull() || radius <= 0)
+        return img;
+
+    // Blurring premultiplied pixels keeps transparent edges clean.
+    QImage srcImg = img.convertToFormat(img.hasAlphaChannel()
+                                        ? QImage::Format_ARGB32_Premultiplied
+                                        : QImage::Format_RGB32);
+    QImage tmpImg(srcImg.size(), srcImg.format());
+    const int width = srcImg.width();
+    const int height = srcImg.height();
+    const int bytesPerLine = srcImg.bytesPerLine();
+    uchar* srcBits = srcImg.bits();
+    uchar* tmpBits = tmpImg.bits();
+
+    int radii[3];
+    boxesForGauss(radius, radii);
+
+    const int rowBands = (height + BLUR_BAND_ROWS - 1)/BLUR_BAND_ROWS;
+    const int columnStrips = (width + BLUR_STRIP_PIXELS - 1)/BLUR_STRIP_PIXELS;
+    for (int pass = 0; pass < 3; pass++) {
+        const int boxRadius = radii[pass];
+        if (boxRadius <= 0)
+            continue;
+
+        parallelFor(rowBands, [&](int band) {
+            const int bottom = std::min(height, (band + 1)*BLUR_BAND_ROWS);
+            for (int y = band*BLUR_BAND_ROWS; y < bottom; y++) {
+                boxBlurRow(reinterpret_cast<const quint32*>(srcBits + y*bytesPerLine),
+                           reinterpret_cast<quint32*>(tmpBits + y*bytesPerLine),
+                           width, boxRadius);
+            }
+        });
+
+        parallelFor(columnStrips, [&](int strip) {
+            boxBlurColumns(tmpBits, srcBits, bytesPerLine, height, strip*BLUR_STRIP_PIXELS,
+                           std::min(width, (strip + 1)*BLUR_STRIP_PIXELS), boxRadius);
+        });
+    }
+
+    return srcImg;
+}
+
+int blurMargin(int radius) {
+    if (radius <= 0)
+        return 0;
+
+    int radii[3];
+    boxesForGauss(radius, radii);
+    return radii[0] + radii[1] + radii[2];
+}
+
+namespace {
+/* Summed area table with one 32 bit lane per channel, row and column 0
+ * are zero. The sums wrap on huge images, but a cell's sum is taken as
+ * a difference and stays far below 2^32, so it is still exact. */
+QVector<quint32> summedAreaTable(const uchar* bits, int width, int height,
+                                 int bytesPerLine) {
+    const int stride = (width + 1)*4;
+    QVector<quint32> table(stride*(height + 1), 0);
+    quint32* sat = table.data();
+    for (int y = 0; y < height; y++) {
+        const quint32* line = reinterpret_cast<const quint32*>(bits + y*bytesPerLine);
+        const quint32* above = sat + y*stride + 4;
+        quint32* row = sat + (y + 1)*stride + 4;
+#ifdef __SSE2__
+        const __m128i zero = _mm_setzero_si128();
+        __m128i sum = zero;
+        for (int x = 0; x < width; x++) {
+            __m128i px = _mm_cvtsi32_si128(line[x]);
+            sum = _mm_add_epi32(sum, _mm_unpacklo_epi16(_mm_unpacklo_epi8(px, zero), zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(row + x*4), _mm_add_epi32(
+                                 sum, _mm_loadu_si128(reinterpret_cast<const __m128i*>(above + x*4))));
+        }
+#else
+        quint32 sum[4] = {0, 0, 0, 0};
+        for (int x = 0; x < width; x++) {
+            for (int c = 0; c < 4; c++) {
+                sum[c] += (line[x] >> (c*8)) & 0xff;
+                row[x*4 + c] = sum[c] + above[x*4 + c];
+            }
+        }
+#endif
+    }
+
+    return table;
+}
+
+/* Average of the pixels in [left, right) x [top, bottom), packed back
+ * into one pixel. */
+quint32 cellAverage(const quint32* sat, int stride, int left, int top,
+                    int right, int bottom) {
+    const quint32* tl = sat + top*stride + left*4;
+    const quint32* tr = sat + top*stride + right*4;
+    const quint32* bl = sat + bottom*stride + left*4;
+    const quint32* br = sat + bottom*stride + right*4;
+    const float inv = 1.0f/((right - left)*(bottom - top));
+#ifdef __SSE2__
+    auto load = [](const quint32* p) {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    };
+    __m128i sum = _mm_add_epi32(_mm_sub_epi32(load(br), load(tr)),
+                                _mm_sub_epi32(load(tl), load(bl)));
+    __m128i avg = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(sum), _mm_set1_ps(inv)),
+                                              _mm_set1_ps(0.5f)));
+    avg = _mm_packs_epi32(avg, avg);
+    return quint32(_mm_cvtsi128_si32(_mm_packus_epi16(avg, avg)));
+#else
+    quint32 px = 0;
+    for (int c = 0; c < 4; c++) {
+        quint32 sum = br[c] - tr[c] - bl[c] + tl[c];
+        px |= quint32(sum*inv + 0.5f) << (c*8);
+    }
+    return px;
+#endif
+}
+
+void fillSpan(quint32* dst, int count, quint32 px) {
+    int x = 0;
+#ifdef __SSE2__
+    const __m128i fill = _mm_set1_epi32(int(px));
+    for (; x + 4 <= count; x += 4) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), fill);
+    }
+#endif
+    for (; x < count; x++) {
+        dst[x] = px;
+    }
+}
+}
+
+QImage pixelateImage(const QImage &img, int cellSize) {
+    if (img.isNull() || cellSize <= 1)
+        return img;
+
+    QImage srcImg = img.convertToFormat(img.hasAlphaChannel()
+                                        ? QImage::Format_ARGB32_Premultiplied
+                                        : QImage::Format_RGB32);
+    const int width = srcImg.width();
+    const int height = srcImg.height();
+    const int bytesPerLine = srcImg.bytesPerLine();
+    uchar* bits = srcImg.bits();
+
+    QVector<quint32> table = summedAreaTable(bits, width, height, bytesPerLine);
+    const quint32* sat = table.constData();
+    const int stride = (width + 1)*4;
+    // The cells are anchored at the top left, edge cells are cut short.
+    for (int top = 0; top < height; top += cellSize) {
+        const int bottom = std::min(height, top + cellSize);
+        for (int left = 0; left < width; left += cellSize) {
+            const int right = std::min(width, left + cellSize);
+            const quint32 px = cellAverage(sat, stride, left, top, right, bottom);
+            for (int y = top; y < bottom; y++) {
+                fillSpan(reinterpret_cast<quint32*>(bits + y*bytesPerLine) + left,
+                         right - left, px);
+            }
+        }
+    }
+
+    return srcImg;
+}
+
+QImage multiplyImage(const QImage &img, QRgb color) {
+    if (img.isNull())
+        return img;
+
+    QImage srcImg = img.convertToFormat(img.hasAlphaChannel()
+                                        ? QImage::Format_ARGB32_Premultiplied
+                                        : QImage::Format_RGB32);
+    const int width = srcImg.width();
+    const int height = srcImg.height();
+    const int bytesPerLine = srcImg.bytesPerLine();
+    uchar* bits = srcImg.bits();
+    // Alpha is multiplied by 255, which leaves it as it is.
+    const quint32 factors = color | 0xff000000;
+
+    // x*c/255 rounded, as (t + (t >> 8)) >> 8 with t = x*c + 128.
+    parallelFor((height + BLUR_BAND_ROWS - 1)/BLUR_BAND_ROWS, [&](int band) {
+        const int bottom = std::min(height, (band + 1)*BLUR_BAND_ROWS);
+        for (int y = band*BLUR_BAND_ROWS; y < bottom; y++) {
+            quint32* line = reinterpret_cast<quint32*>(bits + y*bytesPerLine);
+            int x = 0;
+#ifdef __SSE2__
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i factor = _mm_unpacklo_epi8(_mm_set1_epi32(int(factors)), zero);
+            const __m128i round = _mm_set1_epi16(128);
+            auto multiply = [&](__m128i px) {
+                __m128i t = _mm_add_epi16(_mm_mullo_epi16(px, factor), round);
+                return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+            };
+            for (; x + 4 <= width; x += 4) {
+                __m128i* ptr = reinterpret_cast<__m128i*>(line + x);
+                __m128i px = _mm_loadu_si128(ptr);
+                _mm_storeu_si128(ptr, _mm_packus_epi16(multiply(_mm_unpacklo_epi8(px, zero)),
+                                                       multiply(_mm_unpackhi_epi8(px, zero))));
+            }
+#endif
+            for (; x < width; x++) {
+                quint32 px = 0;
+                for (int c = 0; c < 32; c += 8) {
+                    quint32 t = ((line[x] >> c) & 0xff)*((factors >> c) & 0xff) + 128;
+                    px |= ((t + (t >> 8)) >> 8) << c;
+                }
+                line[x] = px;
+            }
+        }
+    });
+
+    return srcImg;
+}
@@ -0,0 +1,25 @@
+#ifndef IMAGEFILTERS_H
+#define IMAGEFILTERS_H
+
+#include <QImage>
+
+/* Reduce an opaque image to an Indexed8 image of at most maxColors
+ * colors, the palette is exact if the image has few enough colors,
+ * otherwise it is built by median cut. */
+QImage quantizeImage(const QImage &img, int maxColors);
+
+/* Approximate a gaussian blur of the given radius (sigma) with three
+ * separable box passes, the rows and columns are split in bands
+ * which run on the global thread pool. */
+QImage blurImage(const QImage &img, int radius);
+/* how far blurImage reads around a pixel for the given radius */
+int blurMargin(int radius);
+
+/* Replace every cellSize square, anchored at the top left, with its
+ * average color, the averages come from a summed area table. */
+QImage pixelateImage(const QImage &img, int cellSize);
+
+/* Multiply every pixel with color, like a highlighter pen. */
+QImage multiplyImage(const QImage &img, QRgb color);
+
+#endif // IMAGEFILTERS_H
@@ -0,0 +1,120 @@
+#include "imagewriter.h"
+#include "pngencoder.h"
+#include "qoiencoder.h"
+#include "imagefilters.h"
+#include "configsettings.h"
+#include "baseutils.h"
+
+#include <QElapsedTimer>
+#include <QImageWriter>
+#include <QFileInfo>
+#include <QDebug>
+
+#include <algorithm>
+
+ImageWriter::ImageWriter(QObject *parent)
+    : QThread(parent) {
+}
+
+void ImageWriter::write(const QImage &img, const QString &path,
+                        const QByteArray &format, const QVariant &userData) {
+    WriteJob job;
+    job.img = img;
+    job.path = path;
+    job.format = (format.isEmpty() ? QFileInfo(path).suffix().toLocal8Bit()
+                                   : format).toLower();
+    job.userData = userData;
+    job.pngLevel = ConfigSettings::instance()->value("save", "png_level", 6).toInt();
+    job.quality = qBound(0, ConfigSettings::instance()->value(
+                             "save", "save_quality", 100).toInt(), 100);
+
+    {
+        QMutexLocker locker(&m_mutex);
+        m_jobs.enqueue(job);
+        m_jobAdded.wakeOne();
+    }
+
+    if (!isRunning()) {
+        start();
+    }
+}
+
+void ImageWriter::waitForFlushed() {
+    QMutexLocker locker(&m_mutex);
+    while (!m_jobs.isEmpty() || m_busy) {
+        m_flushed.wait(&m_mutex);
+    }
+}
+
+bool ImageWriter::hasPending() {
+    QMutexLocker locker(&m_mutex);
+    return !m_jobs.isEmpty() || m_busy;
+}
+
+void ImageWriter::run() {
+    forever {
+        WriteJob job;
+        {
+            QMutexLocker locker(&m_mutex);
+            while (m_jobs.isEmpty() && !m_stopped) {
+                m_jobAdded.wait(&m_mutex);
+            }
+            // Pending jobs are still written on shutdown.
+            if (m_jobs.isEmpty())
+                return;
+
+            job = m_jobs.dequeue();
+            m_busy = true;
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+        bool ok;
+        if (job.format == "png") {
+            QImage img = job.img;
+            // Below full quality png trades colors for size, the slider
+            // range 50 - 99 maps to a 16 - 256 color palette.
+            if (job.quality < 100 && !img.hasAlphaChannel()) {
+                int colors = 16 + std::max(job.quality - 50, 0)*240/49;
+                img = quantizeImage(img, colors);
+            }
+            ok = PngEncoder::save(img, job.path, job.pngLevel);
+        } else if (job.format == "qoi") {
+            ok = QoiEncoder::save(job.img, job.path);
+        } else if (job.format == "jpg" || job.format == "jpeg" || job.format == "webp") {
+            // The webp plugin switches to lossless at quality 100.
+            QImageWriter writer(job.path, job.format);
+            writer.setQuality(job.quality);
+            ok = writer.write(job.img);
+            if (!ok) {
+                qWarning() << "write failed:" << writer.errorString();
+            }
+        } else {
+            ok = job.img.save(job.path, job.format.isEmpty() ? nullptr
+                                                             : job.format.constData());
+        }
+        qCDebug(paintLog) << "write image:" << job.path << ok << "format:" << job.format
+                          << "quality:" << job.quality
+                          << "encode:" << timer.elapsed() << "ms" << "size:" << QFileInfo(job.path).size();
+
+        {
+            QMutexLocker locker(&m_mutex);
+            m_busy = false;
+            if (m_jobs.isEmpty()) {
+                m_flushed.wakeAll();
+            }
+        }
+
+        emit written(job.path, ok, job.userData);
+    }
+}
+
+ImageWriter::~ImageWriter() {
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopped = true;
+        m_jobAdded.wakeAll();
+    }
+
+    wait();
+}
@@ -0,0 +1,50 @@
+#ifndef IMAGEWRITER_H
+#define IMAGEWRITER_H
+
+#include <QThread>
+#include <QImage>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QQueue>
+#include <QVariant>
+
+/* Encode and write images on a worker thread, the GUI thread only
+ * queues the image and gets written() back when the file is on disk,
+ * together with the userData it passed to write(). */
+class ImageWriter : public QThread {
+    Q_OBJECT
+public:
+    ImageWriter(QObject* parent = 0);
+    ~ImageWriter();
+
+    void write(const QImage &img, const QString &path,
+               const QByteArray &format = QByteArray(),
+               const QVariant &userData = QVariant());
+    /* block until every queued image has been written */
+    void waitForFlushed();
+    bool hasPending();
+
+signals:
+    void written(const QString &path, bool ok, const QVariant &userData);
+
+protected:
+    void run() Q_DECL_OVERRIDE;
+
+private:
+    struct WriteJob {
+        QImage img;
+        QString path;
+        QByteArray format;
+        QVariant userData;
+        int pngLevel;
+        int quality;
+    };
+
+    QQueue<WriteJob> m_jobs;
+    QMutex m_mutex;
+    QWaitCondition m_jobAdded;
+    QWaitCondition m_flushed;
+    bool m_busy = false;
+    bool m_stopped = false;
+};
+#endif // IMAGEWRITER_H
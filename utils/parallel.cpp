@@ -0,0 +1,82 @@
+#include "parallel.h"
+
+#include <QThreadPool>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QAtomicInt>
+
+#include <algorithm>
+
+namespace {
+thread_local bool serialThread = false;
+
+struct ParallelJobs {
+    const std::function<void(int)>* func;
+    int count;
+    QAtomicInt next;
+    QSemaphore finished;
+
+    void runAll() {
+        int index;
+        while ((index = next.fetchAndAddRelaxed(1)) < count) {
+            (*func)(index);
+        }
+    }
+};
+
+class ParallelRunnable : public QRunnable {
+public:
+    ParallelRunnable(ParallelJobs* jobs) : m_jobs(jobs) {
+        setAutoDelete(true);
+    }
+
+    void run() Q_DECL_OVERRIDE {
+        m_jobs->runAll();
+        m_jobs->finished.release();
+    }
+
+private:
+    ParallelJobs* m_jobs;
+};
+}
+
+void parallelFor(int count, const std::function<void(int)> &func) {
+    if (count <= 0)
+        return;
+
+    if (serialThread) {
+        for (int i = 0; i < count; i++) {
+            func(i);
+        }
+        return;
+    }
+
+    ParallelJobs jobs;
+    jobs.func = &func;
+    jobs.count = count;
+    jobs.next = 0;
+
+    QThreadPool* pool = QThreadPool::globalInstance();
+    int helpers = std::min(count, pool->maxThreadCount()) - 1;
+    int started = 0;
+    for (int i = 0; i < helpers; i++) {
+        ParallelRunnable* runnable = new ParallelRunnable(&jobs);
+        if (!pool->tryStart(runnable)) {
+            delete runnable;
+            break;
+        }
+        started++;
+    }
+
+    jobs.runAll();
+    jobs.finished.acquire(started);
+}
+
+SerialScope::SerialScope()
+    : m_wasSerial(serialThread) {
+    serialThread = true;
+}
+
+SerialScope::~SerialScope() {
+    serialThread = m_wasSerial;
+}
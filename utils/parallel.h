@@ -0,0 +1,21 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <functional>
+
+/* Run func(0) .. func(count - 1) on the global thread pool, the calling
+ * thread takes jobs too, so it never waits on a busy pool. */
+void parallelFor(int count, const std::function<void(int)> &func);
+
+/* While a SerialScope is alive, parallelFor calls from its thread run
+ * every job on that thread and leave the pool alone. */
+class SerialScope {
+public:
+    SerialScope();
+    ~SerialScope();
+
+private:
+    bool m_wasSerial;
+};
+
+#endif // PARALLEL_H
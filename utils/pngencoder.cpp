@@ -0,0 +1,307 @@
+#include "pngencoder.h"
+#include "parallel.h"
+
+#include <QFile>
+#include <QVector>
+#include <QDebug>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <zlib.h>
+
+namespace {
+const int BAND_BYTES = 256*1024;
+
+enum PngColorType {
+    PngRgb = 2,
+    PngPalette = 3,
+    PngRgba = 6,
+};
+
+inline int bytesPerPixel(PngColorType type) {
+    switch (type) {
+    case PngPalette: return 1;
+    case PngRgba: return 4;
+    default: return 3;
+    }
+}
+
+struct PngBand {
+    QByteArray data;
+    uLong adler;
+    uLong length;
+    bool ok;
+};
+
+/* unpack one scanline into the png byte order */
+void packRow(const QImage &img, int y, uchar* dst, PngColorType type) {
+    if (type == PngPalette) {
+        memcpy(dst, img.constScanLine(y), img.width());
+        return;
+    }
+
+    const QRgb* src = reinterpret_cast<const QRgb*>(img.constScanLine(y));
+    const int width = img.width();
+    if (type == PngRgba) {
+        for (int x = 0; x < width; x++) {
+            *dst++ = qRed(src[x]);
+            *dst++ = qGreen(src[x]);
+            *dst++ = qBlue(src[x]);
+            *dst++ = qAlpha(src[x]);
+        }
+    } else {
+        for (int x = 0; x < width; x++) {
+            *dst++ = qRed(src[x]);
+            *dst++ = qGreen(src[x]);
+            *dst++ = qBlue(src[x]);
+        }
+    }
+}
+
+inline uchar paeth(int a, int b, int c) {
+    int p = a + b - c;
+    int pa = std::abs(p - a);
+    int pb = std::abs(p - b);
+    int pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc)
+        return a;
+    return pb <= pc ? b : c;
+}
+
+/* Write the filter type and the filtered row to dst, prev is null on
+ * the first row of the image. */
+void filterRow(int type, const uchar* row, const uchar* prev, int length,
+               int bpp, uchar* dst) {
+    dst[0] = type;
+    dst++;
+    for (int i = 0; i < length; i++) {
+        int a = i >= bpp ? row[i - bpp] : 0;
+        int b = prev ? prev[i] : 0;
+        int c = (prev && i >= bpp) ? prev[i - bpp] : 0;
+        switch (type) {
+        case 0: dst[i] = row[i]; break;
+        case 1: dst[i] = row[i] - a; break;
+        case 2: dst[i] = row[i] - b; break;
+        case 3: dst[i] = row[i] - ((a + b) >> 1); break;
+        default: dst[i] = row[i] - paeth(a, b, c); break;
+        }
+    }
+}
+
+/* The usual libpng heuristic, a smaller sum of signed residuals
+ * compresses better. */
+uLong filterCost(const uchar* filtered, int length) {
+    uLong sum = 0;
+    for (int i = 1; i <= length; i++) {
+        sum += std::abs(static_cast<signed char>(filtered[i]));
+    }
+    return sum;
+}
+
+void filterBand(const QImage &img, int top, int bottom, PngColorType type,
+                int level, QByteArray &filtered) {
+    const int bpp = bytesPerPixel(type);
+    const int rowBytes = img.width()*bpp;
+    QByteArray rowBuf(rowBytes, 0);
+    QByteArray prevBuf(rowBytes, 0);
+    QByteArray tryBuf(rowBytes + 1, 0);
+    uchar* row = reinterpret_cast<uchar*>(rowBuf.data());
+    uchar* prev = reinterpret_cast<uchar*>(prevBuf.data());
+    uchar* trial = reinterpret_cast<uchar*>(tryBuf.data());
+
+    filtered.resize((bottom - top)*(rowBytes + 1));
+    uchar* dst = reinterpret_cast<uchar*>(filtered.data());
+
+    if (top > 0) {
+        packRow(img, top - 1, prev, type);
+    }
+
+    for (int y = top; y < bottom; y++) {
+        packRow(img, y, row, type);
+        const uchar* prevRow = y > 0 ? prev : nullptr;
+
+        // Palette indices don't predict well, png recommends no filter.
+        if (level == 0 || type == PngPalette) {
+            filterRow(0, row, prevRow, rowBytes, bpp, dst);
+        } else if (level <= 2) {
+            // Sub alone is cheap and good enough for the fast levels.
+            filterRow(1, row, prevRow, rowBytes, bpp, dst);
+        } else {
+            filterRow(0, row, prevRow, rowBytes, bpp, dst);
+            uLong bestCost = filterCost(dst, rowBytes);
+            for (int type = 1; type <= 4; type++) {
+                filterRow(type, row, prevRow, rowBytes, bpp, trial);
+                uLong cost = filterCost(trial, rowBytes);
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    memcpy(dst, trial, rowBytes + 1);
+                }
+            }
+        }
+
+        dst += rowBytes + 1;
+        std::swap(row, prev);
+    }
+}
+
+/* Deflate one band as raw deflate data. Every band but the last ends on
+ * a sync flush, which leaves it byte aligned and not final, so the bands
+ * can simply be concatenated. */
+bool deflateBand(const QByteArray &filtered, int level, bool last, QByteArray &out) {
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (deflateInit2(&stream, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        return false;
+
+    out.resize(deflateBound(&stream, filtered.size()) + 16);
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(filtered.constData()));
+    stream.avail_in = filtered.size();
+    stream.next_out = reinterpret_cast<Bytef*>(out.data());
+    stream.avail_out = out.size();
+
+    int ret = deflate(&stream, last ? Z_FINISH : Z_SYNC_FLUSH);
+    bool ok = last ? ret == Z_STREAM_END : (ret == Z_OK && stream.avail_in == 0);
+    out.resize(stream.total_out);
+    deflateEnd(&stream);
+
+    return ok;
+}
+
+void writeUInt32(QByteArray &buf, quint32 val) {
+    buf.append(char(val >> 24));
+    buf.append(char(val >> 16));
+    buf.append(char(val >> 8));
+    buf.append(char(val));
+}
+
+bool writeChunk(QIODevice* device, const char* type, const QByteArray &data) {
+    QByteArray chunk;
+    chunk.reserve(data.size() + 12);
+    writeUInt32(chunk, data.size());
+    chunk.append(type, 4);
+    chunk.append(data);
+    uLong crc = crc32(0L, reinterpret_cast<const Bytef*>(chunk.constData() + 4),
+                      data.size() + 4);
+    writeUInt32(chunk, crc);
+
+    return device->write(chunk) == chunk.size();
+}
+
+/* zlib header, FLEVEL is only informative */
+QByteArray zlibHeader(int level) {
+    QByteArray header;
+    header.append(char(0x78));
+    if (level <= 1) {
+        header.append(char(0x01));
+    } else if (level <= 5) {
+        header.append(char(0x5e));
+    } else if (level == 6) {
+        header.append(char(0x9c));
+    } else {
+        header.append(char(0xda));
+    }
+
+    return header;
+}
+}
+
+bool PngEncoder::write(const QImage &img, QIODevice* device, int level) {
+    if (img.isNull() || !device)
+        return false;
+
+    level = qBound(0, level, 9);
+    PngColorType type;
+    QImage srcImg;
+    if (img.format() == QImage::Format_Indexed8) {
+        type = PngPalette;
+        srcImg = img;
+    } else if (img.hasAlphaChannel()) {
+        type = PngRgba;
+        srcImg = img.convertToFormat(QImage::Format_ARGB32);
+    } else {
+        type = PngRgb;
+        srcImg = img.convertToFormat(QImage::Format_RGB32);
+    }
+
+    const int width = srcImg.width();
+    const int height = srcImg.height();
+    const int rowBytes = width*bytesPerPixel(type) + 1;
+    const int bandRows = std::max(1, BAND_BYTES/rowBytes);
+    const int bandCount = (height + bandRows - 1)/bandRows;
+
+    QVector<PngBand> bands(bandCount);
+    parallelFor(bandCount, [&](int index) {
+        int top = index*bandRows;
+        int bottom = std::min(height, top + bandRows);
+        QByteArray filtered;
+        filterBand(srcImg, top, bottom, type, level, filtered);
+
+        PngBand &band = bands[index];
+        band.length = filtered.size();
+        band.adler = adler32(adler32(0L, Z_NULL, 0),
+                             reinterpret_cast<const Bytef*>(filtered.constData()),
+                             filtered.size());
+        band.ok = deflateBand(filtered, level, index == bandCount - 1, band.data);
+    });
+
+    QByteArray header;
+    writeUInt32(header, width);
+    writeUInt32(header, height);
+    header.append(char(8));
+    header.append(char(type));
+    header.append(char(0)); // compression
+    header.append(char(0)); // filter
+    header.append(char(0)); // interlace
+
+    static const char signature[] = "\x89PNG\r\n\x1a\n";
+    if (device->write(signature, 8) != 8 || !writeChunk(device, "IHDR", header))
+        return false;
+
+    if (type == PngPalette) {
+        QByteArray palette;
+        QByteArray alphas;
+        bool hasAlpha = false;
+        for (QRgb color : srcImg.colorTable()) {
+            palette.append(char(qRed(color)));
+            palette.append(char(qGreen(color)));
+            palette.append(char(qBlue(color)));
+            alphas.append(char(qAlpha(color)));
+            hasAlpha |= qAlpha(color) != 255;
+        }
+        if (!writeChunk(device, "PLTE", palette)
+                || (hasAlpha && !writeChunk(device, "tRNS", alphas)))
+            return false;
+    }
+
+    uLong adler = adler32(0L, Z_NULL, 0);
+    for (int i = 0; i < bandCount; i++) {
+        if (!bands[i].ok) {
+            qWarning() << "deflate failed on band" << i;
+            return false;
+        }
+
+        adler = adler32_combine(adler, bands[i].adler, bands[i].length);
+        QByteArray data = bands[i].data;
+        if (i == 0) {
+            data.prepend(zlibHeader(level));
+        }
+        if (i == bandCount - 1) {
+            writeUInt32(data, adler);
+        }
+        if (!writeChunk(device, "IDAT", data))
+            return false;
+    }
+
+    return writeChunk(device, "IEND", QByteArray());
+}
+
+bool PngEncoder::save(const QImage &img, const QString &path, int level) {
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Failed to open" << path;
+        return false;
+    }
+
+    return write(img, &file, level);
+}
@@ -0,0 +1,17 @@
+#ifndef PNGENCODER_H
+#define PNGENCODER_H
+
+#include <QImage>
+#include <QIODevice>
+
+/* Png writer which filters and deflates row bands in parallel, the
+ * bands are stitched into a single zlib stream the way pigz does it.
+ * Indexed8 images are written as palette png. */
+class PngEncoder {
+public:
+    /* level is the zlib compression level, 0 - 9 */
+    static bool write(const QImage &img, QIODevice* device, int level = 6);
+    static bool save(const QImage &img, const QString &path, int level = 6);
+};
+
+#endif // PNGENCODER_H
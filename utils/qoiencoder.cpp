@@ -0,0 +1,132 @@
+#include "qoiencoder.h"
+
+#include <QFile>
+#include <QDebug>
+
+namespace {
+const uchar QOI_OP_INDEX = 0x00;
+const uchar QOI_OP_DIFF = 0x40;
+const uchar QOI_OP_LUMA = 0x80;
+const uchar QOI_OP_RUN = 0xc0;
+const uchar QOI_OP_RGB = 0xfe;
+const uchar QOI_OP_RGBA = 0xff;
+const int QOI_MAX_RUN = 62;
+
+inline int qoiHash(QRgb px) {
+    return (qRed(px)*3 + qGreen(px)*5 + qBlue(px)*7 + qAlpha(px)*11) % 64;
+}
+
+inline void writeUInt32(uchar* &dst, quint32 val) {
+    *dst++ = val >> 24;
+    *dst++ = val >> 16;
+    *dst++ = val >> 8;
+    *dst++ = val;
+}
+}
+
+bool QoiEncoder::write(const QImage &img, QIODevice* device) {
+    if (img.isNull() || !device)
+        return false;
+
+    const bool alpha = img.hasAlphaChannel();
+    const int channels = alpha ? 4 : 3;
+    QImage srcImg = img.convertToFormat(alpha ? QImage::Format_ARGB32
+                                              : QImage::Format_RGB32);
+    const int width = srcImg.width();
+    const int height = srcImg.height();
+
+    // Worst case is one QOI_OP_RGBA per pixel, plus header and end marker.
+    QByteArray buffer;
+    buffer.resize(14 + width*height*(channels + 1) + 8);
+    uchar* dst = reinterpret_cast<uchar*>(buffer.data());
+
+    *dst++ = 'q';
+    *dst++ = 'o';
+    *dst++ = 'i';
+    *dst++ = 'f';
+    writeUInt32(dst, width);
+    writeUInt32(dst, height);
+    *dst++ = channels;
+    *dst++ = 0; // sRGB with linear alpha
+
+    QRgb index[64] = {0};
+    QRgb prev = qRgba(0, 0, 0, 255);
+    int run = 0;
+
+    for (int y = 0; y < height; y++) {
+        const QRgb* line = reinterpret_cast<const QRgb*>(srcImg.constScanLine(y));
+        for (int x = 0; x < width; x++) {
+            // Without alpha channel the top byte of RGB32 is undefined.
+            QRgb px = alpha ? line[x] : (line[x] | 0xff000000);
+            if (px == prev) {
+                run++;
+                if (run == QOI_MAX_RUN) {
+                    *dst++ = QOI_OP_RUN | (run - 1);
+                    run = 0;
+                }
+                continue;
+            }
+
+            if (run > 0) {
+                *dst++ = QOI_OP_RUN | (run - 1);
+                run = 0;
+            }
+
+            int hash = qoiHash(px);
+            if (index[hash] == px) {
+                *dst++ = QOI_OP_INDEX | hash;
+            } else {
+                index[hash] = px;
+                if (qAlpha(px) == qAlpha(prev)) {
+                    signed char dr = qRed(px) - qRed(prev);
+                    signed char dg = qGreen(px) - qGreen(prev);
+                    signed char db = qBlue(px) - qBlue(prev);
+                    signed char drg = dr - dg;
+                    signed char dbg = db - dg;
+
+                    if (dr > -3 && dr < 2 && dg > -3 && dg < 2 && db > -3 && db < 2) {
+                        *dst++ = QOI_OP_DIFF | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2);
+                    } else if (drg > -9 && drg < 8 && dg > -33 && dg < 32
+                               && dbg > -9 && dbg < 8) {
+                        *dst++ = QOI_OP_LUMA | (dg + 32);
+                        *dst++ = (drg + 8) << 4 | (dbg + 8);
+                    } else {
+                        *dst++ = QOI_OP_RGB;
+                        *dst++ = qRed(px);
+                        *dst++ = qGreen(px);
+                        *dst++ = qBlue(px);
+                    }
+                } else {
+                    *dst++ = QOI_OP_RGBA;
+                    *dst++ = qRed(px);
+                    *dst++ = qGreen(px);
+                    *dst++ = qBlue(px);
+                    *dst++ = qAlpha(px);
+                }
+            }
+            prev = px;
+        }
+    }
+
+    if (run > 0) {
+        *dst++ = QOI_OP_RUN | (run - 1);
+    }
+
+    for (int i = 0; i < 7; i++) {
+        *dst++ = 0;
+    }
+    *dst++ = 1;
+
+    const qint64 size = dst - reinterpret_cast<uchar*>(buffer.data());
+    return device->write(buffer.constData(), size) == size;
+}
+
+bool QoiEncoder::save(const QImage &img, const QString &path) {
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Failed to open" << path;
+        return false;
+    }
+
+    return write(img, &file);
+}
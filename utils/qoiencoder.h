@@ -0,0 +1,15 @@
+#ifndef QOIENCODER_H
+#define QOIENCODER_H
+
+#include <QImage>
+#include <QIODevice>
+
+/* Writer for the "Quite OK Image" format, a single pass lossless codec
+ * which is much faster than png at a similar size on screenshots. */
+class QoiEncoder {
+public:
+    static bool write(const QImage &img, QIODevice* device);
+    static bool save(const QImage &img, const QString &path);
+};
+
+#endif // QOIENCODER_H
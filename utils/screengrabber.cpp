@@ -0,0 +1,224 @@
+#include "screengrabber.h"
+
+#include <QApplication>
+#include <QDesktopWidget>
+#include <QScreen>
+#include <QPixmap>
+#include <QDebug>
+#include <QtX11Extras/QX11Info>
+
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/extensions/XShm.h>
+
+namespace {
+/* Grab the root window with XShmGetImage into a persistent shared
+ * segment, repeated grabs reuse the segment without allocation. */
+class XShmScreenGrabber : public ScreenGrabber {
+public:
+    XShmScreenGrabber();
+    ~XShmScreenGrabber();
+
+    bool isValid() const;
+    QImage grab(int screenNum, const QRect &rect) Q_DECL_OVERRIDE;
+    QString name() const Q_DECL_OVERRIDE;
+
+private:
+    bool ensureImage(int width, int height);
+    bool ensureSegment(int size);
+    void releaseImage();
+    void releaseSegment();
+
+    Display* m_display = nullptr;
+    XImage* m_image = nullptr;
+    XShmSegmentInfo m_shmInfo;
+    int m_segmentSize = 0;
+    bool m_valid = false;
+    QtScreenGrabber m_fallback;
+};
+
+XShmScreenGrabber::XShmScreenGrabber() {
+    m_shmInfo.shmid = -1;
+    m_shmInfo.shmaddr = nullptr;
+    m_shmInfo.readOnly = False;
+
+    if (!QX11Info::isPlatformX11())
+        return;
+
+    m_display = QX11Info::display();
+    if (m_display && XShmQueryExtension(m_display)) {
+        Visual* visual = DefaultVisual(m_display, DefaultScreen(m_display));
+        // Only the common 24/32 bit TrueColor layout maps to QImage directly.
+        m_valid = visual->red_mask == 0xff0000 && visual->green_mask == 0x00ff00
+                && visual->blue_mask == 0x0000ff;
+    }
+}
+
+XShmScreenGrabber::~XShmScreenGrabber() {
+    releaseImage();
+    releaseSegment();
+}
+
+bool XShmScreenGrabber::isValid() const {
+    return m_valid;
+}
+
+QString XShmScreenGrabber::name() const {
+    return "xshm";
+}
+
+bool XShmScreenGrabber::ensureSegment(int size) {
+    if (size <= m_segmentSize)
+        return true;
+
+    releaseSegment();
+    m_shmInfo.shmid = shmget(IPC_PRIVATE, size, IPC_CREAT | 0600);
+    if (m_shmInfo.shmid < 0) {
+        qWarning() << "shmget failed, size:" << size;
+        return false;
+    }
+
+    m_shmInfo.shmaddr = static_cast<char*>(shmat(m_shmInfo.shmid, nullptr, 0));
+    if (m_shmInfo.shmaddr == reinterpret_cast<char*>(-1)) {
+        shmctl(m_shmInfo.shmid, IPC_RMID, nullptr);
+        m_shmInfo.shmid = -1;
+        m_shmInfo.shmaddr = nullptr;
+        return false;
+    }
+
+    if (!XShmAttach(m_display, &m_shmInfo)) {
+        shmdt(m_shmInfo.shmaddr);
+        shmctl(m_shmInfo.shmid, IPC_RMID, nullptr);
+        m_shmInfo.shmid = -1;
+        m_shmInfo.shmaddr = nullptr;
+        return false;
+    }
+    XSync(m_display, False);
+    // The segment is destroyed automatically once both sides detach.
+    shmctl(m_shmInfo.shmid, IPC_RMID, nullptr);
+
+    m_segmentSize = size;
+    return true;
+}
+
+bool XShmScreenGrabber::ensureImage(int width, int height) {
+    if (m_image && m_image->width == width && m_image->height == height)
+        return true;
+
+    releaseImage();
+    int screen = DefaultScreen(m_display);
+    XImage* image = XShmCreateImage(m_display, DefaultVisual(m_display, screen),
+                                    DefaultDepth(m_display, screen), ZPixmap,
+                                    nullptr, &m_shmInfo, width, height);
+    if (!image)
+        return false;
+
+    if (image->bits_per_pixel != 32 || !ensureSegment(image->bytes_per_line*image->height)) {
+        XDestroyImage(image);
+        return false;
+    }
+
+    image->data = m_shmInfo.shmaddr;
+    m_image = image;
+    return true;
+}
+
+void XShmScreenGrabber::releaseImage() {
+    if (!m_image)
+        return;
+
+    // The pixels belong to the shared segment, not to the XImage.
+    m_image->data = nullptr;
+    XDestroyImage(m_image);
+    m_image = nullptr;
+}
+
+void XShmScreenGrabber::releaseSegment() {
+    if (!m_shmInfo.shmaddr)
+        return;
+
+    XShmDetach(m_display, &m_shmInfo);
+    XSync(m_display, False);
+    shmdt(m_shmInfo.shmaddr);
+    m_shmInfo.shmaddr = nullptr;
+    m_shmInfo.shmid = -1;
+    m_segmentSize = 0;
+}
+
+QImage XShmScreenGrabber::grab(int screenNum, const QRect &rect) {
+    int screen = DefaultScreen(m_display);
+    QRect rootRect(0, 0, DisplayWidth(m_display, screen), DisplayHeight(m_display, screen));
+
+    // XShmGetImage raises BadMatch outside of the root window.
+    if (rect.isEmpty() || !rootRect.contains(rect) || qApp->devicePixelRatio() != 1
+            || !ensureImage(rect.width(), rect.height())) {
+        return m_fallback.grab(screenNum, rect);
+    }
+
+    if (!XShmGetImage(m_display, DefaultRootWindow(m_display), m_image,
+                      rect.x(), rect.y(), AllPlanes)) {
+        qWarning() << "XShmGetImage failed, fallback to grabWindow";
+        return m_fallback.grab(screenNum, rect);
+    }
+
+    // Wrap the segment as const data, writing to the image detaches it.
+    return QImage(reinterpret_cast<const uchar*>(m_image->data), m_image->width,
+                  m_image->height, m_image->bytes_per_line, QImage::Format_RGB32);
+}
+}
+
+QImage QtScreenGrabber::grab(int screenNum, const QRect &rect) {
+    QList<QScreen*> screenList = qApp->screens();
+    if (screenNum < 0 || screenNum >= screenList.length()) {
+        screenNum = 0;
+    }
+
+    QPixmap tmpImg =  screenList[screenNum]->grabWindow(
+                qApp->desktop()->screen(screenNum)->winId(),
+                rect.x(), rect.y(), rect.width(), rect.height());
+    return tmpImg.toImage();
+}
+
+QString QtScreenGrabber::name() const {
+    return "qt";
+}
+
+QImage ScreenGrabber::grabFrame(int screenNum, const QRect &rect) {
+    QImage img = grab(screenNum, rect);
+    if (img.format() != QImage::Format_RGB32) {
+        // bits() detaches an image which borrows the grabber's buffer.
+        img.bits();
+        return img;
+    }
+
+    // X leaves the pad byte undefined, it would leak into the blends
+    // as alpha. Set it while copying out of the grabber's buffer.
+    QImage frame(img.size(), QImage::Format_RGB32);
+    frame.setDevicePixelRatio(img.devicePixelRatio());
+    for (int y = 0; y < img.height(); y++) {
+        const QRgb* src = reinterpret_cast<const QRgb*>(img.constScanLine(y));
+        QRgb* dst = reinterpret_cast<QRgb*>(frame.scanLine(y));
+        for (int x = 0; x < img.width(); x++) {
+            dst[x] = src[x] | 0xff000000;
+        }
+    }
+    return frame;
+}
+
+ScreenGrabber* ScreenGrabber::instance() {
+    static ScreenGrabber* grabber = nullptr;
+    if (!grabber) {
+        XShmScreenGrabber* shmGrabber = new XShmScreenGrabber();
+        if (shmGrabber->isValid()) {
+            grabber = shmGrabber;
+        } else {
+            delete shmGrabber;
+            grabber = new QtScreenGrabber();
+        }
+        qDebug() << "screen grabber:" << grabber->name();
+    }
+
+    return grabber;
+}
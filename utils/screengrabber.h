@@ -0,0 +1,31 @@
+#ifndef SCREENGRABBER_H
+#define SCREENGRABBER_H
+
+#include <QImage>
+#include <QRect>
+
+/* Capture backend, the rect is in root window coordinates. */
+class ScreenGrabber {
+public:
+    virtual ~ScreenGrabber() {}
+
+    /* The raw backend grab, not for use outside of grabFrame(). The
+     * image may borrow the grabber's buffer until the next grab, and
+     * the pad byte of its RGB32 pixels is undefined. */
+    virtual QImage grab(int screenNum, const QRect &rect) = 0;
+    virtual QString name() const = 0;
+
+    /* grab and return an opaque image which owns its pixels */
+    QImage grabFrame(int screenNum, const QRect &rect);
+
+    static ScreenGrabber* instance();
+};
+
+/* Fallback backend, it copies the window over the X socket. */
+class QtScreenGrabber : public ScreenGrabber {
+public:
+    QImage grab(int screenNum, const QRect &rect) Q_DECL_OVERRIDE;
+    QString name() const Q_DECL_OVERRIDE;
+};
+
+#endif // SCREENGRABBER_H
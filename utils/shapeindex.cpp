@@ -0,0 +1,91 @@
+#include "shapeindex.h"
+
+#include <algorithm>
+
+namespace {
+const int CELL_SIZE = 64;
+
+quint64 cellKey(int column, int row) {
+    return (quint64(quint32(row)) << 32) | quint32(column);
+}
+
+int cellOf(int coordinate) {
+    // Round towards negative infinity, handles may reach past the widget.
+    return coordinate >= 0 ? coordinate/CELL_SIZE : (coordinate + 1)/CELL_SIZE - 1;
+}
+}
+
+void ShapeIndex::append(const QRect &bounds) {
+    m_bounds.append(bounds);
+    insertCells(m_bounds.size() - 1);
+}
+
+void ShapeIndex::update(int index, const QRect &bounds) {
+    if (index < 0 || index >= m_bounds.size() || m_bounds[index] == bounds)
+        return;
+
+    removeCells(index);
+    m_bounds[index] = bounds;
+    insertCells(index);
+}
+
+void ShapeIndex::removeAt(int index) {
+    if (index < 0 || index >= m_bounds.size())
+        return;
+
+    // Every later index shifts, rebuilding is simpler than renumbering.
+    m_bounds.remove(index);
+    m_cells.clear();
+    for (int i = 0; i < m_bounds.size(); i++)
+        insertCells(i);
+}
+
+void ShapeIndex::clear() {
+    m_bounds.clear();
+    m_cells.clear();
+}
+
+int ShapeIndex::count() const {
+    return m_bounds.size();
+}
+
+QVector<int> ShapeIndex::candidates(const QPoint &pos) const {
+    QVector<int> result;
+    foreach (int index, m_cells.value(cellKey(cellOf(pos.x()), cellOf(pos.y())))) {
+        if (m_bounds[index].contains(pos))
+            result.append(index);
+    }
+
+    // Updates append to the cells, the callers expect the stacking order.
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+void ShapeIndex::insertCells(int index) {
+    const QRect &bounds = m_bounds[index];
+    if (bounds.isEmpty())
+        return;
+
+    for (int row = cellOf(bounds.top()); row <= cellOf(bounds.bottom()); row++) {
+        for (int column = cellOf(bounds.left()); column <= cellOf(bounds.right()); column++)
+            m_cells[cellKey(column, row)].append(index);
+    }
+}
+
+void ShapeIndex::removeCells(int index) {
+    const QRect &bounds = m_bounds[index];
+    if (bounds.isEmpty())
+        return;
+
+    for (int row = cellOf(bounds.top()); row <= cellOf(bounds.bottom()); row++) {
+        for (int column = cellOf(bounds.left()); column <= cellOf(bounds.right()); column++) {
+            QHash<quint64, QVector<int>>::iterator cell = m_cells.find(cellKey(column, row));
+            if (cell == m_cells.end())
+                continue;
+
+            cell.value().removeOne(index);
+            if (cell.value().isEmpty())
+                m_cells.erase(cell);
+        }
+    }
+}
@@ -0,0 +1,31 @@
+#ifndef SHAPEINDEX_H
+#define SHAPEINDEX_H
+
+#include <QHash>
+#include <QRect>
+#include <QVector>
+
+/* A uniform grid over the hit bounds of the shapes, each cell lists the
+ * indexes of the shapes whose bounds touch it, so a mouse event only runs
+ * the exact hit tests of the shapes under the pointer. Indexes follow the
+ * shape list, removing a shape shifts the ones after it. */
+class ShapeIndex {
+public:
+    void append(const QRect &bounds);
+    void update(int index, const QRect &bounds);
+    void removeAt(int index);
+    void clear();
+    int count() const;
+
+    /* indexes of the shapes whose bounds may contain pos, ascending */
+    QVector<int> candidates(const QPoint &pos) const;
+
+private:
+    void insertCells(int index);
+    void removeCells(int index);
+
+    QVector<QRect> m_bounds;
+    QHash<quint64, QVector<int>> m_cells;
+};
+
+#endif // SHAPEINDEX_H
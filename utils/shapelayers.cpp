@@ -0,0 +1,20 @@
+#include "shapelayers.h"
+
+ShapeLayers splitShapeLayers(const QVector<QRect> &bounds,
+                             const QVector<int> &liveShapes,
+                             const QRegion &region) {
+    ShapeLayers layers;
+    foreach (int i, liveShapes) {
+        layers.live |= bounds[i];
+    }
+    layers.live &= region;
+    layers.cached = region.subtracted(layers.live);
+    if (layers.live.isEmpty())
+        return layers;
+
+    for (int i = 0; i < bounds.size(); i++) {
+        if (layers.live.intersects(bounds[i]))
+            layers.shapes.append(i);
+    }
+    return layers;
+}
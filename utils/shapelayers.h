@@ -0,0 +1,25 @@
+#ifndef SHAPELAYERS_H
+#define SHAPELAYERS_H
+
+#include <QRect>
+#include <QRegion>
+#include <QVector>
+
+/* How a repaint is split between the shapes cache and live painting. The
+ * cache holds every shape but the live ones, so it only fills the region
+ * no live shape reaches. Over the live bounds the shapes touching them
+ * are painted again in list order, a live shape stays under the shapes
+ * after it. */
+struct ShapeLayers {
+    QRegion cached;
+    QRegion live;
+    /* indexes of the shapes to paint over live, ascending */
+    QVector<int> shapes;
+};
+
+/* bounds follows the shape list, liveShapes holds ascending indexes */
+ShapeLayers splitShapeLayers(const QVector<QRect> &bounds,
+                             const QVector<int> &liveShapes,
+                             const QRegion &region);
+
+#endif // SHAPELAYERS_H
@@ -1,5 +1,7 @@
 #include "shapesutils.h"
+#include "calculaterect.h"
 
+#include <QPolygonF>
 #include <QDebug>
 
 Toolshape::Toolshape() {
@@ -10,21 +12,130 @@ Toolshape::Toolshape() {
     portion.clear();
 }
 
+Toolshape::Toolshape(const Toolshape &other) {
+    // operator= keeps the portion of the assigned shape, a copy takes it.
+    *this = other;
+    portion = other.portion;
+}
+
 Toolshape::~Toolshape() {
 }
 
+Toolshape::Kind Toolshape::kindOf(const QString &name) {
+    if (name == "rectangle")
+        return Rectangle;
+    if (name == "oval")
+        return Oval;
+    if (name == "arrow")
+        return Arrow;
+    if (name == "line")
+        return Line;
+    if (name == "text")
+        return Text;
+    return NoKind;
+}
+
+QString Toolshape::nameOf(Kind kind) {
+    switch (kind) {
+    case Rectangle: return "rectangle";
+    case Oval: return "oval";
+    case Arrow: return "arrow";
+    case Line: return "line";
+    case Text: return "text";
+    default: return QString();
+    }
+}
+
+const QPainterPath &Toolshape::path() const {
+    if (!m_pathValid) {
+        switch (kind) {
+        case Rectangle: m_path = rectanglePath(mainPoints); break;
+        case Oval: m_path = ellipsePath(mainPoints); break;
+        case Line: m_path = polylinePath(points); break;
+        default: m_path = QPainterPath(); break;
+        }
+        m_pathValid = true;
+    }
+    return m_path;
+}
+
+const QRectF &Toolshape::bounds() const {
+    if (!m_boundsValid) {
+        QPolygonF outline;
+        switch (kind) {
+        case Arrow:
+        case Line:
+            // The mainPoints of a stroke are only its handles.
+            outline = QPolygonF(points.toVector());
+            break;
+        case Rectangle:
+        case Oval:
+        case Text:
+            outline = QPolygonF(mainPoints.toVector());
+            break;
+        default:
+            // (0, 0) marks an unset point.
+            foreach (QPointF point, mainPoints) {
+                if (point != QPointF(0, 0))
+                    outline << point;
+            }
+            outline << QPolygonF(points.toVector());
+            break;
+        }
+        m_bounds = outline.boundingRect();
+        m_boundsValid = true;
+    }
+    return m_bounds;
+}
+
+void Toolshape::invalidate() {
+    m_pathValid = false;
+    m_boundsValid = false;
+}
+
+void Toolshape::appendPoint(const QPointF &point) {
+    points.append(point);
+    if (m_pathValid) {
+        if (m_path.elementCount() == 0)
+            m_path.moveTo(point);
+        else
+            m_path.lineTo(point);
+    }
+    extendBounds(point);
+}
+
+void Toolshape::setLastPoint(const QPointF &point) {
+    points.last() = point;
+    if (m_pathValid && m_path.elementCount() > 0)
+        m_path.setElementPositionAt(m_path.elementCount() - 1, point.x(), point.y());
+    extendBounds(point);
+}
+
+void Toolshape::extendBounds(const QPointF &point) {
+    if (!m_boundsValid)
+        return;
+
+    if (points.length() == 1 && m_bounds.isNull()) {
+        m_bounds = QRectF(point, QSizeF(0, 0));
+    } else {
+        m_bounds.setLeft(qMin(m_bounds.left(), point.x()));
+        m_bounds.setRight(qMax(m_bounds.right(), point.x()));
+        m_bounds.setTop(qMin(m_bounds.top(), point.y()));
+        m_bounds.setBottom(qMax(m_bounds.bottom(), point.y()));
+    }
+}
+
 void Toolshape::registerMetaType() {
     qRegisterMetaType<Toolshape>();
 }
 
 QDebug &operator<<(QDebug &argument, const Toolshape &obj) {
     argument.nospace()
-            << obj.type << ","
+            << Toolshape::nameOf(obj.kind) << ","
             << "[" << obj.mainPoints << "]" << ","
             << obj.lineWidth << ","
             << obj.colorIndex <<","
-            << obj.isBlur << ","
-            << obj.isMosaic << ","
+            << obj.effect << ","
             << obj.isStraight << ","
             << obj.isShiftPressed << ","
             << obj.fontSize << ","
@@ -36,36 +147,55 @@ QDataStream &operator>>(QDataStream &in, Toolshape &obj) {
     in >> obj.points;
     in >> obj.fontSize;
     in >> obj.isShiftPressed;
-    in >> obj.isBlur;
-    in >> obj.isMosaic;
+    // The stream keeps the isBlur and isMosaic flags of the effect.
+    bool isBlur;
+    bool isMosaic;
+    in >> isBlur;
+    in >> isMosaic;
+    if (isBlur) {
+        obj.effect = "blur";
+    } else if (isMosaic) {
+        obj.effect = "mosaic";
+    } else {
+        obj.effect.clear();
+    }
     in >> obj.isStraight;
     in >> obj.colorIndex;
     in >> obj.lineWidth;
     in >> obj.mainPoints;
-    in >> obj.type;
+    // The kind is streamed by its name.
+    QString type;
+    in >> type;
+    obj.kind = Toolshape::kindOf(type);
+    obj.invalidate();
 
     return in;
 }
 
-Toolshape Toolshape::operator=(Toolshape obj) {
-    type = obj.type;
+Toolshape &Toolshape::operator=(const Toolshape &obj) {
+    kind = obj.kind;
     mainPoints = obj.mainPoints;
     lineWidth = obj.lineWidth;
     colorIndex = obj.colorIndex;
-    isBlur = obj.isBlur;
-    isMosaic = obj.isMosaic;
+    effect = obj.effect;
     isStraight = obj.isStraight;
     isShiftPressed = obj.isShiftPressed;
     fontSize = obj.fontSize;
     points = obj.points;
+    strokeIndex = obj.strokeIndex;
+    // QPainterPath is implicitly shared, a copy keeps the built path.
+    m_path = obj.m_path;
+    m_bounds = obj.m_bounds;
+    m_pathValid = obj.m_pathValid;
+    m_boundsValid = obj.m_boundsValid;
 
     return (*this);
 }
 
 bool Toolshape::operator==(const Toolshape &other) const {
     if (this->mainPoints == other.mainPoints && this->colorIndex == other.colorIndex &&
-            this->fontSize == other.fontSize && this->isBlur == other.isBlur && this->isMosaic
-            == other.isMosaic && this->isShiftPressed == other.isShiftPressed
+            this->fontSize == other.fontSize && this->effect == other.effect
+            && this->isShiftPressed == other.isShiftPressed
             && this->isStraight == other.isStraight && this->points == other.points) {
         return true;
     } else {
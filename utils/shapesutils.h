@@ -3,6 +3,9 @@
 
 #include <QtCore>
 #include <QColor>
+#include <QPainterPath>
+
+#include "strokeindex.h"
 
 typedef QList<QPointF> FourPoints;
 Q_DECLARE_METATYPE(FourPoints)
@@ -10,25 +13,60 @@ Q_DECLARE_METATYPE(FourPoints)
 /* shape*/
 class Toolshape {
 public:
-     QString type;
+    enum Kind {
+        NoKind,
+        Rectangle,
+        Oval,
+        Arrow,
+        Line,
+        Text,
+    };
+    /* the tool name of a kind, it is also the config group */
+    static Kind kindOf(const QString &name);
+    static QString nameOf(Kind kind);
+
+     Kind kind = NoKind;
      FourPoints mainPoints;
-     int lineWidth;
+     int lineWidth = 1;
      int colorIndex;
-     bool isBlur = false;
-     bool isMosaic = false;
+     // name of the effect kernel, empty for a plain shape
+     QString effect;
      bool isStraight = false;
      bool isShiftPressed = false;
      int fontSize = 1;
     QList<QPointF> points;
     QList<QList<qreal>> portion;
+    // bucketed points of a "line" stroke, synced by count when stale
+    StrokeIndex strokeIndex;
     Toolshape();
+    Toolshape(const Toolshape &other);
     ~Toolshape();
 
+    /* the outline of a rectangle or oval, the stroke of a line, and the
+     * rect spanned by the geometry of the kind. Both are built on first
+     * use and shared by copies, so any change of kind, mainPoints or
+     * points outside of the methods below must call invalidate(). */
+    const QPainterPath &path() const;
+    const QRectF &bounds() const;
+    void invalidate();
+    /* record a point of a stroke, the built path and rect follow it, a
+     * moved last point may leave the rect larger than needed */
+    void appendPoint(const QPointF &point);
+    void setLastPoint(const QPointF &point);
+
     friend QDebug &operator<<(QDebug &argument, const Toolshape &obj);
     friend QDataStream &operator>>(QDataStream &in, Toolshape &obj);
-    Toolshape operator=(Toolshape obj);
+    Toolshape &operator=(const Toolshape &obj);
     bool operator==(const Toolshape &other) const;
     static void registerMetaType();
+
+private:
+    void extendBounds(const QPointF &point);
+
+    mutable QPainterPath m_path;
+    mutable QRectF m_bounds;
+    mutable bool m_pathValid = false;
+    mutable bool m_boundsValid = false;
 };
 
 //typedef QList<QPointF> FourPoints;
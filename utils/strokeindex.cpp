@@ -0,0 +1,71 @@
+#include "strokeindex.h"
+#include "calculaterect.h"
+
+#include <cmath>
+
+namespace {
+const int CELL_SIZE = 16;
+// a segment crossing a cell passes this close to its center
+const qreal CELL_REACH = CELL_SIZE*0.7072;
+
+quint64 cellKey(int column, int row) {
+    return (quint64(quint32(row)) << 32) | quint32(column);
+}
+
+int cellOf(qreal coordinate) {
+    return int(std::floor(coordinate/CELL_SIZE));
+}
+}
+
+void StrokeIndex::append(const QPointF &point) {
+    // The first point is a segment of its own, a dot is hit as well.
+    QLineF segment(m_count == 0 ? point : m_last, point);
+    const int bottom = cellOf(qMax(segment.y1(), segment.y2()));
+    const int right = cellOf(qMax(segment.x1(), segment.x2()));
+    for (int row = cellOf(qMin(segment.y1(), segment.y2())); row <= bottom; row++) {
+        for (int column = cellOf(qMin(segment.x1(), segment.x2())); column <= right; column++) {
+            // Only the cells along a long diagonal, not its whole bounds.
+            QPointF center((column + 0.5)*CELL_SIZE, (row + 0.5)*CELL_SIZE);
+            if (pointToSegmentDistance(segment.p1(), segment.p2(), center) <= CELL_REACH)
+                m_cells[cellKey(column, row)].append(segment);
+        }
+    }
+
+    m_last = point;
+    m_count++;
+}
+
+void StrokeIndex::rebuild(const QList<QPointF> &points) {
+    clear();
+    foreach (QPointF point, points)
+        append(point);
+}
+
+void StrokeIndex::clear() {
+    m_cells.clear();
+    m_count = 0;
+}
+
+int StrokeIndex::count() const {
+    return m_count;
+}
+
+bool StrokeIndex::contains(const QPointF &pos, int padding) const {
+    const int bottom = cellOf(pos.y() + padding);
+    const int right = cellOf(pos.x() + padding);
+    for (int row = cellOf(pos.y() - padding); row <= bottom; row++) {
+        for (int column = cellOf(pos.x() - padding); column <= right; column++) {
+            QHash<quint64, QVector<QLineF>>::const_iterator cell =
+                    m_cells.constFind(cellKey(column, row));
+            if (cell == m_cells.constEnd())
+                continue;
+
+            foreach (QLineF segment, cell.value()) {
+                if (pointToSegmentDistance(segment.p1(), segment.p2(), pos) <= padding)
+                    return true;
+            }
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,28 @@
+#ifndef STROKEINDEX_H
+#define STROKEINDEX_H
+
+#include <QHash>
+#include <QLineF>
+#include <QVector>
+
+/* The segments of a freehand stroke bucketed in small square cells, a
+ * point test only visits the cells around the pointer instead of walking
+ * the whole stroke. Appending keeps the buckets in step as it is drawn. */
+class StrokeIndex {
+public:
+    void append(const QPointF &point);
+    void rebuild(const QList<QPointF> &points);
+    void clear();
+    /* the number of points indexed, a stale index differs from its stroke */
+    int count() const;
+
+    /* whether the stroke passes within padding of pos */
+    bool contains(const QPointF &pos, int padding) const;
+
+private:
+    QHash<quint64, QVector<QLineF>> m_cells;
+    QPointF m_last;
+    int m_count = 0;
+};
+
+#endif // STROKEINDEX_H
@@ -0,0 +1,77 @@
+#include "strokesimplifier.h"
+#include "calculaterect.h"
+
+#include <cmath>
+
+namespace {
+// bounds the work per position on a long straight run
+const int MAX_WINDOW = 64;
+const int MAX_SPAN_STEPS = 8;
+
+QPointF catmullRom(const QPointF &p0, const QPointF &p1, const QPointF &p2,
+                   const QPointF &p3, qreal t) {
+    qreal t2 = t*t;
+    qreal t3 = t2*t;
+    return 0.5*(2*p1 + (p2 - p0)*t + (2*p0 - 5*p1 + 4*p2 - p3)*t2
+                + (3*p1 - p0 - 3*p2 + p3)*t3);
+}
+}
+
+StrokeSimplifier::StrokeSimplifier(qreal tolerance)
+    : m_tolerance(tolerance) {
+}
+
+void StrokeSimplifier::begin(const QPointF &point) {
+    m_anchor = point;
+    m_window.clear();
+    m_rawCount = 1;
+}
+
+bool StrokeSimplifier::append(const QPointF &point) {
+    m_rawCount++;
+    if (m_window.isEmpty()) {
+        m_window.append(point);
+        return true;
+    }
+
+    bool fits = m_window.size() < MAX_WINDOW;
+    for (int i = 0; fits && i < m_window.size(); i++)
+        fits = pointToSegmentDistance(m_anchor, point, m_window[i]) <= m_tolerance;
+
+    if (fits) {
+        m_window.append(point);
+        return false;
+    }
+
+    // The last point no longer fits a chord, it starts the next one.
+    m_anchor = m_window.last();
+    m_window.clear();
+    m_window.append(point);
+    return true;
+}
+
+int StrokeSimplifier::rawCount() const {
+    return m_rawCount;
+}
+
+QList<QPointF> StrokeSimplifier::smooth(const QList<QPointF> &points, qreal spacing) {
+    if (points.length() < 3)
+        return points;
+
+    QList<QPointF> result;
+    result.append(points.first());
+    for (int i = 0; i < points.length() - 1; i++) {
+        // The end points are repeated to close the spline off.
+        const QPointF &p0 = points[qMax(0, i - 1)];
+        const QPointF &p1 = points[i];
+        const QPointF &p2 = points[i + 1];
+        const QPointF &p3 = points[qMin(points.length() - 1, i + 2)];
+
+        int steps = qBound(1, int(std::ceil(getDistance(p1, p2)/spacing)), MAX_SPAN_STEPS);
+        for (int step = 1; step < steps; step++)
+            result.append(catmullRom(p0, p1, p2, p3, qreal(step)/steps));
+        result.append(p2);
+    }
+
+    return result;
+}
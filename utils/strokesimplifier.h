@@ -0,0 +1,34 @@
+#ifndef STROKESIMPLIFIER_H
+#define STROKESIMPLIFIER_H
+
+#include <QList>
+#include <QPointF>
+#include <QVector>
+
+/* Streaming Douglas-Peucker over the positions of a stroke being drawn.
+ * The newest position is always the stroke's last point, the one before
+ * it is dropped while every raw position since the last kept point stays
+ * within tolerance of the chord from that point to the newest one. */
+class StrokeSimplifier {
+public:
+    explicit StrokeSimplifier(qreal tolerance = 1.0);
+
+    void begin(const QPointF &point);
+    /* true when the stroke's last point is kept and point follows it,
+     * false when point replaces it */
+    bool append(const QPointF &point);
+    /* positions received since begin() */
+    int rawCount() const;
+
+    /* Catmull-Rom spline through points, a span is split every spacing
+     * pixels, so straight runs stay sparse */
+    static QList<QPointF> smooth(const QList<QPointF> &points, qreal spacing = 12);
+
+private:
+    qreal m_tolerance;
+    QPointF m_anchor;
+    QVector<QPointF> m_window;
+    int m_rawCount = 0;
+};
+
+#endif // STROKESIMPLIFIER_H
@@ -3,11 +3,39 @@ HEADERS += \
     $$PWD/shapesutils.h \
     $$PWD/calculaterect.h \
     $$PWD/configsettings.h \
-    $$PWD/shortcut.h
+    $$PWD/shortcut.h \
+    $$PWD/framestore.h \
+    $$PWD/screengrabber.h \
+    $$PWD/imagewriter.h \
+    $$PWD/parallel.h \
+    $$PWD/pngencoder.h \
+    $$PWD/qoiencoder.h \
+    $$PWD/imagefilters.h \
+    $$PWD/effectkernel.h \
+    $$PWD/effectlayer.h \
+    $$PWD/effectprecomputer.h \
+    $$PWD/shapeindex.h \
+    $$PWD/shapelayers.h \
+    $$PWD/strokeindex.h \
+    $$PWD/strokesimplifier.h
 
 SOURCES += \
     $$PWD/baseutils.cpp \
     $$PWD/shapesutils.cpp \
     $$PWD/calculaterect.cpp \
     $$PWD/configsettings.cpp \
-    $$PWD/shortcut.cpp
+    $$PWD/shortcut.cpp \
+    $$PWD/framestore.cpp \
+    $$PWD/screengrabber.cpp \
+    $$PWD/imagewriter.cpp \
+    $$PWD/parallel.cpp \
+    $$PWD/pngencoder.cpp \
+    $$PWD/qoiencoder.cpp \
+    $$PWD/imagefilters.cpp \
+    $$PWD/effectkernel.cpp \
+    $$PWD/effectlayer.cpp \
+    $$PWD/effectprecomputer.cpp \
+    $$PWD/shapeindex.cpp \
+    $$PWD/shapelayers.cpp \
+    $$PWD/strokeindex.cpp \
+    $$PWD/strokesimplifier.cpp
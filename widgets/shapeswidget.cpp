@@ -7,12 +7,16 @@
 
 #include <QApplication>
 #include <QPainter>
+#include <QElapsedTimer>
 #include <QDebug>
 
 #define LINEWIDTH(index) (index*2+3)
 
 const int DRAG_BOUND_RADIUS = 8;
 const int SPACING = 12;
+/* resize and rotate handles are drawn centered on their points */
+const int HANDLE_PADDING = 14;
+const int CACHE_TILE_SIZE = 128;
 
 using namespace utils;
 
@@ -48,31 +52,46 @@ void ShapesWidget::updateSelectedShape(const QString &group,
                                        const QString &key, int index) {
     qDebug() << "updateSelectedShapes" << m_selectedIndex << m_shapes.length();
 
+    if (group == "effect") {
+        // A new size changes the output of the layers already in use.
+        foreach (QString effect, m_effectLayers.keys()) {
+            QSharedPointer<const EffectKernel> kernel = EffectKernel::create(effect);
+            if (kernel && kernel->sizeKey() == key)
+                emit reloadEffectImg(effect);
+        }
+        return;
+    }
+
     if (m_selectedIndex != -1 && m_selectedIndex < m_shapes.length()) {
-        if (m_selectedShape.type == "arrow" && key != "color_index") {
+        const Toolshape::Kind groupKind = Toolshape::kindOf(group);
+        if (m_selectedShape.kind == Toolshape::Arrow && key != "color_index") {
             if (key == "arrow_linewidth_index" && !m_selectedShape.isStraight) {
                 m_selectedShape.lineWidth = LINEWIDTH(index);
             } else if (key == "straightline_linewidth_index" && m_selectedShape.isStraight) {
                 m_selectedShape.lineWidth = LINEWIDTH(index);
             }
-        } else if (m_selectedShape.type == group && key == "linewidth_index") {
+        } else if (m_selectedShape.kind == groupKind && key == "linewidth_index") {
             m_selectedShape.lineWidth = LINEWIDTH(index);
-        } else if (group == "text" && m_selectedShape.type == group && key == "color_index") {
+        } else if (groupKind == Toolshape::Text && m_selectedShape.kind == groupKind
+                   && key == "color_index") {
             m_editMap.value(m_selectedIndex)->setColor(colorIndexOf(index));
              m_editMap.value(m_selectedIndex)->update();
-        } else if (group == "text" && m_selectedShape.type == group && key == "fontsize")  {
+        } else if (groupKind == Toolshape::Text && m_selectedShape.kind == groupKind
+                   && key == "fontsize")  {
             qDebug() << "setFontsize" << index;
             m_editMap.value(m_selectedIndex)->setFontSize(index);
             m_editMap.value(m_selectedIndex)->update();
-        } else if (group != "text" && m_selectedShape.type == group && key == "color_index") {
+        } else if (groupKind != Toolshape::Text && m_selectedShape.kind == groupKind
+                   && key == "color_index") {
             m_selectedShape.colorIndex = index;
         }
 
         if (m_selectedIndex < m_shapes.length())
         {
             m_shapes[m_selectedIndex] = m_selectedShape;
+            updateShapeIndex(m_selectedIndex);
         }
-        update();
+        updateLiveShapes();
     }
 }
 
@@ -82,8 +101,10 @@ void ShapesWidget::updatePenColor() {
 }
 
 void ShapesWidget::setCurrentShape(QString shapeType) {
-    if (shapeType != "saveList")
+    if (shapeType != "saveList") {
         m_currentType = shapeType;
+        m_currentKind = Toolshape::kindOf(shapeType);
+    }
 }
 
 void ShapesWidget::setPenColor(QColor color) {
@@ -93,13 +114,13 @@ void ShapesWidget::setPenColor(QColor color) {
         ConfigSettings::instance()->setValue(m_currentType, "color_index", colorNum);
     }
 
-    if (m_currentType != "line") {
+    if (m_currentKind != Toolshape::Line) {
         qApp->setOverrideCursor(setCursorShape(m_currentType));
     } else {
         qApp->setOverrideCursor(setCursorShape("line",  colorNum));
     }
 
-    update();
+    updateLiveShapes();
 }
 
 void ShapesWidget::clearSelected() {
@@ -111,6 +132,15 @@ void ShapesWidget::clearSelected() {
     m_isSelected = false;
     m_selectedShape.points.clear();
     m_hoveredShape.points.clear();
+    m_selectedShape.invalidate();
+    m_hoveredShape.invalidate();
+
+    // The deselected shape goes back into the cache, composeFrozenImg()
+    // renders right after this.
+    if (m_selectedIndex >= 0 && m_selectedIndex < m_shapes.length())
+        invalidateShapesCache(shapeBounds(m_shapes[m_selectedIndex]));
+    m_selectedIndex = -1;
+    updateLiveShapes();
 }
 
 void ShapesWidget::setAllTextEditReadOnly() {
@@ -122,60 +152,34 @@ void ShapesWidget::setAllTextEditReadOnly() {
     }
 
     m_editing = false;
-    update();
+    updateLiveShapes();
 }
 
 bool ShapesWidget::clickedOnShapes(QPointF pos) {
     bool onShapes = false;
     m_selectedIndex = -1;
 
-    qDebug() << "ClickedOnShapes !!!!!!!";
-    for (int i = 0; i < m_shapes.length(); i++) {
-        bool currentOnShape = false;
-        if (m_shapes[i].type == "rectangle") {
-            if (clickedOnRect(m_shapes[i].mainPoints, pos,
-                              m_shapes[i].isBlur || m_shapes[i].isMosaic)) {
-                currentOnShape = true;
-            }
-        }
-        if (m_shapes[i].type == "oval") {
-            if (clickedOnEllipse(m_shapes[i].mainPoints, pos,
-                                 m_shapes[i].isBlur || m_shapes[i].isMosaic)) {
-                currentOnShape = true;
-            }
-        }
-        if (m_shapes[i].type == "arrow") {
-            if (clickedOnArrow(m_shapes[i].points, pos)) {
-                currentOnShape = true;
-            }
-        }
-        if (m_shapes[i].type == "line") {
-            if (clickedOnLine(m_shapes[i].mainPoints, m_shapes[i].points, pos)) {
-                currentOnShape = true;
-            }
-        }
-
-        if (m_shapes[i].type == "text") {
-            if (clickedOnText(m_shapes[i].mainPoints, pos)) {
-                currentOnShape = true;
-            }
-        }
+    // The tests below leave these behind when nothing is hit.
+    m_isSelected = false;
+    m_isResize = false;
+    m_isRotated = false;
 
-        if (currentOnShape) {
+    qDebug() << "ClickedOnShapes !!!!!!!";
+    foreach (int i, m_shapeIndex.candidates(pos.toPoint())) {
+        if (clickedOnShape(m_shapes[i], pos)) {
             m_selectedShape = m_shapes[i];
             m_selectedIndex = i;
             onShapes = true;
             break;
-        } else {
-            update();
-            continue;
         }
     }
-        return onShapes;
+
+    updateLiveShapes();
+    return onShapes;
 }
 
     //TODO: selectUnique
-bool ShapesWidget::clickedOnRect(FourPoints rectPoints, QPointF pos, bool isBlurMosaic) {
+bool ShapesWidget::clickedOnRect(FourPoints rectPoints, QPointF pos, bool isEffect) {
     m_isSelected = false;
     m_isResize = false;
     m_isRotated = false;
@@ -257,7 +261,7 @@ bool ShapesWidget::clickedOnRect(FourPoints rectPoints, QPointF pos, bool isBlur
         m_resizeDirection = Moving;
         m_pressedPoint = pos;
         return true;
-    } else if(isBlurMosaic && pointInRect(rectPoints, pos)) {
+    } else if(isEffect && pointInRect(rectPoints, pos)) {
         m_isSelected = true;
         m_isResize = false;
         m_resizeDirection = Moving;
@@ -272,7 +276,7 @@ bool ShapesWidget::clickedOnRect(FourPoints rectPoints, QPointF pos, bool isBlur
     return false;
 }
 
-bool ShapesWidget::clickedOnEllipse(FourPoints mainPoints, QPointF pos, bool isBlurMosaic) {
+bool ShapesWidget::clickedOnEllipse(FourPoints mainPoints, QPointF pos, bool isEffect) {
     m_isSelected = false;
     m_isResize = false;
     m_isRotated = false;
@@ -349,7 +353,7 @@ bool ShapesWidget::clickedOnEllipse(FourPoints mainPoints, QPointF pos, bool isB
             m_resizeDirection = Moving;
             m_pressedPoint = pos;
             return true;
-    } else if(isBlurMosaic && pointInRect(mainPoints, pos)) {
+    } else if(isEffect && pointInRect(mainPoints, pos)) {
         m_isSelected = true;
         m_isResize = false;
         m_resizeDirection = Moving;
@@ -401,7 +405,7 @@ bool ShapesWidget::clickedOnArrow(QList<QPointF> points, QPointF pos) {
 }
 
 bool ShapesWidget::clickedOnLine(FourPoints mainPoints,
-                                      QList<QPointF> points, QPointF pos) {
+                                      const StrokeIndex &stroke, QPointF pos) {
     m_isSelected = false;
     m_isResize = false;
     m_isRotated = false;
@@ -471,7 +475,7 @@ bool ShapesWidget::clickedOnLine(FourPoints mainPoints,
         m_resizeDirection = Rotate;
         m_pressedPoint = pos;
         return true;
-    }  else if (pointOnArLine(points, pos)) {
+    }  else if (pointOnArLine(stroke, pos)) {
             m_isSelected = true;
             m_isResize = false;
 
@@ -606,7 +610,7 @@ bool ShapesWidget::hoverOnArrow(QList<QPointF> points, QPointF pos) {
     }
 }
 
-bool ShapesWidget::hoverOnLine(FourPoints mainPoints, QList<QPointF> points,
+bool ShapesWidget::hoverOnLine(FourPoints mainPoints, const StrokeIndex &stroke,
                                QPointF pos) {
     FourPoints tmpFPoints = getAnotherFPoints(mainPoints);
 
@@ -637,7 +641,7 @@ bool ShapesWidget::hoverOnLine(FourPoints mainPoints, QList<QPointF> points,
     } else if (pointClickIn(tmpFPoints[3], pos)) {
         m_resizeDirection = Bottom;
         return true;
-    }  else if (pointOnArLine(points, pos)) {
+    }  else if (pointOnArLine(stroke, pos)) {
         m_isSelected = true;
         m_isResize = false;
 
@@ -649,18 +653,40 @@ bool ShapesWidget::hoverOnLine(FourPoints mainPoints, QList<QPointF> points,
     }
     return false;
 }
-bool ShapesWidget::hoverOnShapes(Toolshape toolShape, QPointF pos) {
-    if (toolShape.type == "rectangle") {
+bool ShapesWidget::clickedOnShape(Toolshape &shape, QPointF pos) {
+    switch (shape.kind) {
+    case Toolshape::Rectangle:
+        return clickedOnRect(shape.mainPoints, pos, !shape.effect.isEmpty());
+    case Toolshape::Oval:
+        return clickedOnEllipse(shape.mainPoints, pos, !shape.effect.isEmpty());
+    case Toolshape::Arrow:
+        return clickedOnArrow(shape.points, pos);
+    case Toolshape::Line:
+        syncStrokeIndex(shape);
+        return clickedOnLine(shape.mainPoints, shape.strokeIndex, pos);
+    case Toolshape::Text:
+        return clickedOnText(shape.mainPoints, pos);
+    default:
+        return false;
+    }
+}
+
+bool ShapesWidget::hoverOnShapes(const Toolshape &toolShape, QPointF pos) {
+    switch (toolShape.kind) {
+    case Toolshape::Rectangle:
         return hoverOnRect(toolShape.mainPoints, pos);
-    } else if (toolShape.type == "oval") {
+    case Toolshape::Oval:
         return hoverOnEllipse(toolShape.mainPoints, pos);
-    }  else if (toolShape.type == "arrow") {
+    case Toolshape::Arrow:
         return hoverOnArrow(toolShape.points, pos);
-    } else if (toolShape.type == "line") {
-        return hoverOnLine(toolShape.mainPoints, toolShape.points, pos);
+    case Toolshape::Line:
+        return hoverOnLine(toolShape.mainPoints, toolShape.strokeIndex, pos);
+    default:
+        break;
     }
 
-    m_hoveredShape.type = "";
+    m_hoveredShape.kind = Toolshape::NoKind;
+    m_hoveredShape.invalidate();
     return false;
 }
 
@@ -694,13 +720,14 @@ void ShapesWidget::handleDrag(QPointF oldPoint, QPointF newPoint)  {
         return;
     }
 
-    if (m_shapes[m_selectedIndex].type == "arrow") {
+    if (m_shapes[m_selectedIndex].kind == Toolshape::Arrow) {
         for(int i = 0; i < m_shapes[m_selectedIndex].points.length(); i++) {
             m_shapes[m_selectedIndex].points[i] = QPointF(
                         m_shapes[m_selectedIndex].points[i].x() + (newPoint.x() - oldPoint.x()),
                         m_shapes[m_selectedIndex].points[i].y() + (newPoint.y() - oldPoint.y())
                         );
         }
+        m_shapes[m_selectedIndex].invalidate();
         return;
     }
 
@@ -718,6 +745,7 @@ void ShapesWidget::handleDrag(QPointF oldPoint, QPointF newPoint)  {
                     m_shapes[m_selectedIndex].points[i].y() + (newPoint.y() - oldPoint.y())
                     );
     }
+    m_shapes[m_selectedIndex].invalidate();
 }
 
 ////////////////////TODO: perfect handleRotate..
@@ -728,7 +756,7 @@ void ShapesWidget::handleRotate(QPointF pos) {
         return;
     }
 
-    if (m_selectedShape.type == "arrow") {
+    if (m_selectedShape.kind == Toolshape::Arrow) {
         if (m_shapes[m_selectedIndex].isShiftPressed) {
             if (m_shapes[m_selectedIndex].points[0].x() == m_shapes[m_selectedIndex].points[1].x()) {
                 if (m_clickedKey == First) {
@@ -755,6 +783,7 @@ void ShapesWidget::handleRotate(QPointF pos) {
 
         m_selectedShape.points  =  m_shapes[m_selectedIndex].points;
         m_hoveredShape.points = m_shapes[m_selectedIndex].points;
+        invalidateSelectedShape();
         m_pressedPoint = pos;
         return;
     }
@@ -777,6 +806,7 @@ void ShapesWidget::handleRotate(QPointF pos) {
 
     m_selectedShape.mainPoints = m_shapes[m_selectedIndex].mainPoints;
     m_hoveredShape.mainPoints =  m_shapes[m_selectedIndex].mainPoints;
+    invalidateSelectedShape();
     m_pressedPoint = pos;
 }
 
@@ -811,6 +841,7 @@ void ShapesWidget::handleResize(QPointF pos, int key) {
 
         m_selectedShape.points = m_shapes[m_selectedIndex].points;
         m_hoveredShape.points = m_shapes[m_selectedIndex].points;
+        invalidateSelectedShape();
     }
     m_pressedPoint = pos;
 }
@@ -831,7 +862,7 @@ void ShapesWidget::mousePressEvent(QMouseEvent *e) {
         qDebug() << "no one shape be clicked!";
         clearSelected();
 
-        m_currentShape.type = m_currentType;
+        m_currentShape.kind = m_currentKind;
         m_currentShape.colorIndex = ConfigSettings::instance()->value(
                     m_currentType, "color_index").toInt();
         m_currentShape.lineWidth = LINEWIDTH(ConfigSettings::instance()->value(
@@ -842,9 +873,11 @@ void ShapesWidget::mousePressEvent(QMouseEvent *e) {
 
         if (m_pos1 == QPointF(0, 0)) {
             m_pos1 = e->pos();
-            if (m_currentType == "line") {
-                m_currentShape.points.append(m_pos1);
-            } else if (m_currentType == "arrow") {
+            if (m_currentKind == Toolshape::Line) {
+                m_currentShape.appendPoint(m_pos1);
+                m_currentShape.strokeIndex.append(m_pos1);
+                m_strokeSimplifier.begin(m_pos1);
+            } else if (m_currentKind == Toolshape::Arrow) {
                 m_currentShape.isShiftPressed = m_isShiftPressed;
                 m_currentShape.points.append(m_pos1);
                 m_currentShape.isStraight = ConfigSettings::instance()->value(
@@ -856,20 +889,15 @@ void ShapesWidget::mousePressEvent(QMouseEvent *e) {
                     m_currentShape.lineWidth = LINEWIDTH(ConfigSettings::instance()->value(
                                                              "arrow", "arrow_linewidth_index").toInt());
                 }
-            } else if (m_currentType == "rectangle" || m_currentType == "oval") {
-                m_currentShape.isBlur = ConfigSettings::instance()->value(
-                                                              "effect", "is_blur").toBool();
-                m_currentShape.isMosaic = ConfigSettings::instance()->value(
-                                                                  "effect", "is_mosaic").toBool();
+            } else if (m_currentKind == Toolshape::Rectangle || m_currentKind == Toolshape::Oval) {
+                m_currentShape.effect = ConfigSettings::instance()->value(
+                                                              "effect", "current").toString();
                 m_currentShape.isShiftPressed = m_isShiftPressed;
-                if (m_currentShape.isBlur && !m_blurEffectExist) {
-                    emit reloadEffectImg("blur");
-                    m_blurEffectExist = true;
-                } else if (m_currentShape.isMosaic &&  !m_mosaicEffectExist){
-                    emit reloadEffectImg("mosaic");
-                    m_mosaicEffectExist = true;
+                if (!m_currentShape.effect.isEmpty()
+                        && !m_effectLayers.contains(m_currentShape.effect)) {
+                    emit reloadEffectImg(m_currentShape.effect);
                 }
-            } else if (m_currentType == "text") {
+            } else if (m_currentKind == Toolshape::Text) {
                 qDebug() << "MMMM";
                 if (m_editing) {
                     m_editing = false;
@@ -900,10 +928,11 @@ void ShapesWidget::mousePressEvent(QMouseEvent *e) {
                         m_selectedIndex = index;
                         m_selectedShape = m_shapes[index];
                     });
-                    m_shapes.append(m_currentShape);
+                    appendShape(m_currentShape);
                 }
             }
-            update();
+            m_currentShape.invalidate();
+            updateLiveShapes();
         }
     } else {
         m_isRecording = false;
@@ -913,7 +942,7 @@ void ShapesWidget::mousePressEvent(QMouseEvent *e) {
             m_editMap.value(m_selectedIndex)->setCursorVisible(false);
             m_editMap.value(m_selectedIndex)->setFocusPolicy(Qt::NoFocus);
         }
-        update();
+        updateLiveShapes();
     }
 
     QFrame::mousePressEvent(e);
@@ -926,7 +955,7 @@ void ShapesWidget::mouseReleaseEvent(QMouseEvent *e) {
     qDebug() << m_isRecording << m_isSelected << m_pos2;
 
     if (m_isRecording && !m_isSelected && m_pos2 != QPointF(0, 0)) {
-        if (m_currentType == "arrow") {
+        if (m_currentKind == Toolshape::Arrow) {
             if (m_currentShape.points.length() == 2) {
                 if (m_isShiftPressed) {
                     if (std::atan2(std::abs(m_pos2.y() - m_pos1.y()), std::abs(m_pos2.x() - m_pos1.x()))
@@ -939,16 +968,25 @@ void ShapesWidget::mouseReleaseEvent(QMouseEvent *e) {
 
                 m_currentShape.points[1] = m_pos2;
                 m_currentShape.mainPoints = getMainPoints(m_currentShape.points[0], m_currentShape.points[1]);
-                m_shapes.append(m_currentShape);
+                appendShape(m_currentShape);
             }
-        } else if (m_currentType == "line") {
+        } else if (m_currentKind == Toolshape::Line) {
+            if (m_currentShape.points.length() > 1)
+                m_currentShape.strokeIndex.append(m_currentShape.points.last());
+            if (ConfigSettings::instance()->value("line", "smooth", false).toBool()) {
+                m_currentShape.points = StrokeSimplifier::smooth(m_currentShape.points);
+                m_currentShape.strokeIndex.rebuild(m_currentShape.points);
+            }
+            qCDebug(paintLog) << "stroke points:" << m_strokeSimplifier.rawCount()
+                              << "->" << m_currentShape.points.length();
+
             FourPoints lineFPoints = fourPointsOfLine(m_currentShape.points);
             m_currentShape.mainPoints = lineFPoints;
-            m_shapes.append(m_currentShape);
-        } else if (m_currentType != "text"){
+            appendShape(m_currentShape);
+        } else if (m_currentKind != Toolshape::Text){
             FourPoints rectFPoints = getMainPoints(m_pos1, m_pos2, m_isShiftPressed);
             m_currentShape.mainPoints = rectFPoints;
-            m_shapes.append(m_currentShape);
+            appendShape(m_currentShape);
         }
 
         qDebug() << "ShapesWidget num:" << m_shapes.length();
@@ -956,17 +994,19 @@ void ShapesWidget::mouseReleaseEvent(QMouseEvent *e) {
     }
 
     m_isRecording = false;
-    if (m_currentShape.type != "text") {
+    if (m_currentShape.kind != Toolshape::Text) {
         for(int i = 0; i < m_currentShape.mainPoints.length(); i++) {
             m_currentShape.mainPoints[i] = QPointF(0, 0);
         }
     }
 
     m_currentShape.points.clear();
+    m_currentShape.strokeIndex.clear();
+    m_currentShape.invalidate();
     m_pos1 = QPointF(0, 0);
     m_pos2 = QPointF(0, 0);
 
-    update();
+    updateLiveShapes();
     QFrame::mouseReleaseEvent(e);
 }
 
@@ -977,7 +1017,7 @@ void ShapesWidget::mouseMoveEvent(QMouseEvent *e) {
     if (m_isRecording && m_isPressed) {
         m_pos2 = e->pos();
 
-        if (m_currentShape.type == "arrow") {
+        if (m_currentShape.kind == Toolshape::Arrow) {
             if (m_currentShape.points.length() <= 1) {
                 if (m_isShiftPressed) {
                         if (std::atan2(std::abs(m_pos2.y() - m_pos1.y()),
@@ -1001,37 +1041,51 @@ void ShapesWidget::mouseMoveEvent(QMouseEvent *e) {
                     m_currentShape.points[1] = m_pos2;
                 }
             }
+            m_currentShape.invalidate();
         }
-        if (m_currentShape.type == "line") {
-             m_currentShape.points.append(m_pos2);
+        // The path drops repeated points, the stroke skips them as well.
+        if (m_currentShape.kind == Toolshape::Line && (m_currentShape.points.isEmpty()
+                || m_currentShape.points.last() != m_pos2)) {
+            // The last point follows the mouse, it is indexed once kept.
+            if (m_strokeSimplifier.append(m_pos2)) {
+                if (m_currentShape.points.length() > 1)
+                    m_currentShape.strokeIndex.append(m_currentShape.points.last());
+                m_currentShape.appendPoint(m_pos2);
+            } else {
+                m_currentShape.setLastPoint(m_pos2);
+            }
         }
-        update();
+        updateLiveShapes();
     } else if (!m_isRecording && m_isPressed) {
         if (m_isRotated && m_isPressed) {
             handleRotate(e->pos());
-            update();
+            updateShapeIndex(m_selectedIndex);
+            updateLiveShapes();
         }
 
         if (m_isResize && m_isPressed) {
             // resize function
             handleResize(QPointF(e->pos()), m_clickedKey);
-            update();
+            updateShapeIndex(m_selectedIndex);
+            updateLiveShapes();
             QFrame::mouseMoveEvent(e);
             return;
         }
 
         if (m_isSelected && m_isPressed && m_selectedIndex != -1) {
             handleDrag(m_pressedPoint, m_movingPoint);
+            updateShapeIndex(m_selectedIndex);
             m_selectedShape = m_shapes[m_selectedIndex];
             m_hoveredShape = m_shapes[m_selectedIndex];
 
             m_pressedPoint = m_movingPoint;
-            update();
+            updateLiveShapes();
         }
     } else {
         if (!m_isRecording) {
             m_isHovered = false;
-            for (int i = 0; i < m_shapes.length(); i++) {
+            foreach (int i, m_shapeIndex.candidates(e->pos())) {
+                 syncStrokeIndex(m_shapes[i]);
                  if (hoverOnShapes(m_shapes[i],  e->pos())) {
                      m_isHovered = true;
                      m_hoveredShape = m_shapes[i];
@@ -1088,32 +1142,34 @@ void ShapesWidget::mouseMoveEvent(QMouseEvent *e) {
                      } else if (m_resizeDirection == Moving) {
                          qApp->setOverrideCursor(Qt::ClosedHandCursor);
                      } else {
-                         if (m_currentType == "line") {
+                         if (m_currentKind == Toolshape::Line) {
                              qApp->setOverrideCursor(setCursorShape(m_currentType, colorIndex(m_penColor)));
                          } else {
                              qApp->setOverrideCursor(setCursorShape(m_currentType));
                          }
                      }
-                     update();
+                     updateLiveShapes();
                      break;
-                 } else {
-                     if (m_currentType == "line") {
-                         qApp->setOverrideCursor(setCursorShape(m_currentType, colorIndex(m_penColor)));
-                     } else {
-                         qApp->setOverrideCursor(setCursorShape(m_currentType));
-                     }
-                     update();
                  }
             }
             if (!m_isHovered) {
                 for(int j = 0; j < m_hoveredShape.mainPoints.length(); j++) {
                     m_hoveredShape.mainPoints[j] = QPointF(0, 0);
                 }
-                m_hoveredShape.type = "";
-                update();
+                m_hoveredShape.kind = Toolshape::NoKind;
+                m_hoveredShape.invalidate();
+                m_resizeDirection = Outting;
+                updateLiveShapes();
+            }
+            if (!m_isHovered && !m_shapes.isEmpty()) {
+                if (m_currentKind == Toolshape::Line) {
+                    qApp->setOverrideCursor(setCursorShape(m_currentType, colorIndex(m_penColor)));
+                } else {
+                    qApp->setOverrideCursor(setCursorShape(m_currentType));
+                }
             }
             if (m_shapes.length() == 0) {
-                if (m_currentType == "line") {
+                if (m_currentKind == Toolshape::Line) {
                     qApp->setOverrideCursor(setCursorShape(m_currentType, colorIndex(m_penColor)));
                 } else {
                     qApp->setOverrideCursor(setCursorShape(m_currentType));
@@ -1136,12 +1192,19 @@ void ShapesWidget::updateTextRect(TextEdit* edit, QRectF newRect) {
         m_shapes[index].mainPoints[2] = QPointF(newRect.x() + newRect.width(), newRect.y());
         m_shapes[index].mainPoints[3] = QPointF(newRect.x() + newRect.width(),
                                                                                      newRect.y() + newRect.height());
+        m_shapes[index].invalidate();
 
         m_currentShape  = m_shapes[index];
         m_selectedShape = m_shapes[index];
         m_selectedIndex = index;
+        updateShapeIndex(index);
     }
-    update();
+    updateLiveShapes();
+}
+
+void ShapesWidget::setEffectLayer(const QString &effect, const EffectLayer &layer) {
+    m_effectLayers.insert(effect, layer);
+    invalidateShapesCache();
 }
 
 void ShapesWidget::paintImgPoint(QPainter &painter, QPointF pos, QPixmap img, bool isResize) {
@@ -1155,60 +1218,38 @@ void ShapesWidget::paintImgPoint(QPainter &painter, QPointF pos, QPixmap img, bo
 }
 
 void ShapesWidget::paintRect(QPainter &painter, FourPoints rectFPoints, int index,
-                                                       bool isBlur, bool isMosaic) {
-    QPainterPath rectPath;
-    if ((isBlur | isMosaic) && index != m_selectedIndex) {
-        painter.setPen(Qt::transparent);
-    }
-    rectPath.moveTo(rectFPoints[0].x(), rectFPoints[0].y());
-    rectPath.lineTo(rectFPoints[1].x(),rectFPoints[1].y());
-    rectPath.lineTo(rectFPoints[3].x(),rectFPoints[3].y());
-    rectPath.lineTo(rectFPoints[2].x(),rectFPoints[2].y());
-    rectPath.lineTo(rectFPoints[0].x(),rectFPoints[0].y());
-    painter.drawPath(rectPath);
-
-    using namespace utils;
-    if (isBlur) {
-        painter.setClipPath(rectPath);
-        painter.drawPixmap(0, 0,  width(), height(),  TMP_BLUR_FILE);
-        painter.drawPath(rectPath);
-    }
-    if (isMosaic) {
-        painter.setClipPath(rectPath);
-        painter.drawPixmap(0, 0,  width(), height(),  TMP_MOSA_FILE);
-        painter.drawPath(rectPath);
-    }
-    painter.setClipping(false);
+                                                       const QString &effect) {
+    paintOutline(painter, rectanglePath(rectFPoints), index, effect);
 }
 
 void ShapesWidget::paintEllipse(QPainter &painter, FourPoints ellipseFPoints, int index,
-                                                           bool isBlur, bool isMosaic) {
-    if ((isBlur | isMosaic)  && index != m_selectedIndex) {
+                                                           const QString &effect) {
+    paintOutline(painter, ellipsePath(ellipseFPoints), index, effect);
+}
+
+void ShapesWidget::paintOutline(QPainter &painter, const QPainterPath &path, int index,
+                                const QString &effect) {
+    if (!effect.isEmpty() && index != m_selectedIndex) {
         painter.setPen(Qt::transparent);
     }
+    painter.drawPath(path);
+    paintEffect(painter, path, effect);
+}
 
-    FourPoints minorPoints = getAnotherFPoints(ellipseFPoints);
-    QList<QPointF> eightControlPoints = getEightControlPoint(ellipseFPoints);
-    QPainterPath ellipsePath;
-    ellipsePath.moveTo(minorPoints[0].x(), minorPoints[0].y());
-    ellipsePath.cubicTo(eightControlPoints[0], eightControlPoints[1], minorPoints[1]);
-    ellipsePath.cubicTo(eightControlPoints[4], eightControlPoints[5], minorPoints[2]);
-    ellipsePath.cubicTo(eightControlPoints[6], eightControlPoints[7], minorPoints[3]);
-    ellipsePath.cubicTo(eightControlPoints[3], eightControlPoints[2], minorPoints[0]);
-    painter.drawPath(ellipsePath);
-
-    using namespace utils;
-    if (isBlur) {
-        painter.setClipPath(ellipsePath);
-        painter.drawPixmap(0, 0,  width(), height(),  TMP_BLUR_FILE);
-        painter.drawPath(ellipsePath);
-    }
-    if (isMosaic) {
-        painter.setClipPath(ellipsePath);
-        painter.drawPixmap(0, 0,  width(), height(),  TMP_MOSA_FILE);
-        painter.drawPath(ellipsePath);
-    }
-    painter.setClipping(false);
+void ShapesWidget::paintEffect(QPainter &painter, const QPainterPath &path,
+                               const QString &effect) {
+    if (effect.isEmpty() || !m_effectLayers.contains(effect))
+        return;
+    EffectLayer &layer = m_effectLayers[effect];
+
+    // Only the tiles under the shape's bounding rect are computed.
+    QRect blitRect = path.boundingRect().toAlignedRect().intersected(rect());
+    // The shapes cache clips to its dirty tiles, keep that clip.
+    painter.save();
+    painter.setClipPath(path, Qt::IntersectClip);
+    layer.draw(painter, blitRect);
+    painter.drawPath(path);
+    painter.restore();
 }
 
 void ShapesWidget::paintArrow(QPainter &painter, QList<QPointF> lineFPoints,
@@ -1234,9 +1275,17 @@ void ShapesWidget::paintArrow(QPainter &painter, QList<QPointF> lineFPoints,
     }
 }
 
-void ShapesWidget::paintLine(QPainter &painter, QList<QPointF> lineFPoints) {
-    for (int k = 0; k < lineFPoints.length() - 2; k++) {
-        painter.drawLine(lineFPoints[k], lineFPoints[k+1]);
+void ShapesWidget::paintLine(QPainter &painter, QList<QPointF> lineFPoints,
+                             const QPainterPath &path) {
+    // One stroke joins the segments, they no longer overlap at each point.
+    QPen pen = painter.pen();
+    pen.setCapStyle(Qt::RoundCap);
+    pen.setJoinStyle(Qt::RoundJoin);
+    if (path.elementCount() == lineFPoints.length()) {
+        painter.strokePath(path, pen);
+    } else {
+        painter.setPen(pen);
+        painter.drawPolyline(QPolygonF(lineFPoints.toVector()));
     }
 }
 
@@ -1254,47 +1303,259 @@ void ShapesWidget::paintText(QPainter &painter, FourPoints rectFPoints) {
     }
 }
 
-void ShapesWidget::paintEvent(QPaintEvent *) {
+void ShapesWidget::paintShape(QPainter &painter, const Toolshape &shape, int index) {
+    QPen pen;
+    pen.setColor(colorIndexOf(shape.colorIndex));
+    pen.setWidth(shape.lineWidth);
+    painter.setPen(pen);
+    switch (shape.kind) {
+    case Toolshape::Rectangle:
+    case Toolshape::Oval:
+        paintOutline(painter, shape.path(), index, shape.effect);
+        break;
+    case Toolshape::Arrow:
+        paintArrow(painter, shape.points, pen.width(), shape.isStraight);
+        break;
+    case Toolshape::Line:
+        paintLine(painter, shape.points, shape.path());
+        break;
+    case Toolshape::Text:
+        if (!(m_editMap.value(index)->isReadOnly() && m_selectedIndex != index)) {
+            paintText(painter, shape.mainPoints);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+bool ShapesWidget::isLiveShape(int index) const {
+    // Text frames follow the editors, the selected shape follows the mouse.
+    return index == m_selectedIndex || m_shapes[index].kind == Toolshape::Text;
+}
+
+QRect ShapesWidget::shapeBounds(const Toolshape &shape) const {
+    QRectF outline = shape.bounds();
+    if (outline.isNull())
+        return QRect();
+
+    // The pen is centered on the outline, an arrow head reaches further.
+    qreal padding = shape.lineWidth/2.0 + 2;
+    if (shape.kind == Toolshape::Arrow)
+        padding += 8 + (shape.lineWidth - 1)*2;
+    return outline.adjusted(-padding, -padding, padding, padding).toAlignedRect();
+}
+
+QRect ShapesWidget::handleBounds(const Toolshape &shape) const {
+    QRect bounds = shapeBounds(shape);
+    if (bounds.isEmpty())
+        return bounds;
+
+    if (shape.kind != Toolshape::Arrow && shape.kind != Toolshape::Text
+            && shape.mainPoints.length() == 4) {
+        // The handles sit on the mainPoints, which may enclose a stroke.
+        bounds |= QPolygonF(shape.mainPoints.toVector()).boundingRect().toAlignedRect();
+        QPointF rotatePoint = getRotatePoint(shape.mainPoints[0], shape.mainPoints[1],
+                                             shape.mainPoints[2], shape.mainPoints[3]);
+        bounds |= QRectF(rotatePoint, rotatePoint).toAlignedRect();
+    }
+    return bounds.adjusted(-HANDLE_PADDING, -HANDLE_PADDING, HANDLE_PADDING, HANDLE_PADDING);
+}
+
+QRect ShapesWidget::selectedBounds() const {
+    return handleBounds(m_selectedShape);
+}
+
+QRect ShapesWidget::hitBounds(const Toolshape &shape) const {
+    // Handles are hit on every shape, the rotate handle up to SPACING
+    // past its drawn bounds.
+    return handleBounds(shape).adjusted(-SPACING, -SPACING, SPACING, SPACING);
+}
+
+void ShapesWidget::appendShape(const Toolshape &shape) {
+    m_shapes.append(shape);
+    // The appended copy builds its own bounds from the final points.
+    m_shapes.last().invalidate();
+    m_shapeIndex.append(hitBounds(m_shapes.last()));
+    invalidateShapesCache(shapeBounds(m_shapes.last()));
+}
+
+void ShapesWidget::updateShapeIndex(int index) {
+    if (index >= 0 && index < m_shapes.length()) {
+        m_shapeIndex.update(index, hitBounds(m_shapes[index]));
+        // Moved points are rebucketed on the next hit test.
+        m_shapes[index].strokeIndex.clear();
+    }
+}
+
+void ShapesWidget::invalidateSelectedShape() {
+    if (m_selectedIndex >= 0 && m_selectedIndex < m_shapes.length())
+        m_shapes[m_selectedIndex].invalidate();
+    m_selectedShape.invalidate();
+    m_hoveredShape.invalidate();
+}
+
+void ShapesWidget::syncStrokeIndex(Toolshape &shape) {
+    if (shape.kind == Toolshape::Line && shape.strokeIndex.count() != shape.points.length())
+        shape.strokeIndex.rebuild(shape.points);
+}
+
+QRect ShapesWidget::liveShapesBounds() const {
+    QRect bounds = selectedBounds() | shapeBounds(m_hoveredShape);
+    for (int i = 0; i < m_shapes.length(); i++) {
+        if (isLiveShape(i))
+            bounds |= shapeBounds(m_shapes[i]);
+    }
+
+    if (m_pos1 != QPointF(0, 0) && m_pos2 != QPointF(0, 0)) {
+        Toolshape drawingShape = m_currentShape;
+        drawingShape.mainPoints = getMainPoints(m_pos1, m_pos2, m_isShiftPressed);
+        drawingShape.invalidate();
+        bounds |= shapeBounds(drawingShape);
+    } else if (m_currentShape.kind == Toolshape::Text) {
+        bounds |= shapeBounds(m_currentShape);
+    }
+    return bounds;
+}
+
+void ShapesWidget::updateLiveShapes() {
+    // Repaint where the live shapes were and where they are now.
+    QRect liveRect = liveShapesBounds();
+    update(QRegion(m_lastLiveRect) | liveRect);
+    m_lastLiveRect = liveRect;
+}
+
+QRect ShapesWidget::cacheTiles(const QRect &rect) const {
+    if (rect.isEmpty())
+        return QRect();
+
+    // Whole tiles keep the dirty region simple.
+    const int left = std::floor(qreal(rect.left())/CACHE_TILE_SIZE)*CACHE_TILE_SIZE;
+    const int top = std::floor(qreal(rect.top())/CACHE_TILE_SIZE)*CACHE_TILE_SIZE;
+    const int right = (std::floor(qreal(rect.right())/CACHE_TILE_SIZE) + 1)*CACHE_TILE_SIZE;
+    const int bottom = (std::floor(qreal(rect.bottom())/CACHE_TILE_SIZE) + 1)*CACHE_TILE_SIZE;
+    return QRect(left, top, right - left, bottom - top).intersected(this->rect());
+}
+
+void ShapesWidget::invalidateShapesCache(const QRect &rect) {
+    QRect tileRect = cacheTiles(rect);
+    if (tileRect.isEmpty())
+        return;
+
+    m_shapesCacheDirty |= tileRect;
+    update(tileRect);
+}
+
+void ShapesWidget::invalidateShapesCache() {
+    m_shapesCacheDirty = QRegion(rect());
+    updateLiveShapes();
+}
+
+const QImage &ShapesWidget::shapesCache() {
+    const qreal ratio = devicePixelRatioF();
+    const QSize cacheSize = size()*ratio;
+    if (m_shapesCache.size() != cacheSize) {
+        m_shapesCache = QImage(cacheSize, QImage::Format_ARGB32_Premultiplied);
+        m_shapesCache.setDevicePixelRatio(ratio);
+        m_shapesCacheDirty = QRegion(rect());
+    }
+
+    // The selected shape moves between the cache and the live shapes,
+    // both areas are inside the live bounds being repainted.
+    if (m_cachedSelectedIndex != m_selectedIndex) {
+        if (m_cachedSelectedIndex >= 0 && m_cachedSelectedIndex < m_shapes.length())
+            m_shapesCacheDirty |= cacheTiles(shapeBounds(m_shapes[m_cachedSelectedIndex]));
+        if (m_selectedIndex >= 0 && m_selectedIndex < m_shapes.length())
+            m_shapesCacheDirty |= cacheTiles(shapeBounds(m_shapes[m_selectedIndex]));
+        m_cachedSelectedIndex = m_selectedIndex;
+    }
+
+    if (m_shapesCacheDirty.isEmpty())
+        return m_shapesCache;
+
+    QElapsedTimer timer;
+    timer.start();
+    QPainter painter(&m_shapesCache);
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+    for (const QRect &rect : m_shapesCacheDirty.rects()) {
+        painter.fillRect(rect, Qt::transparent);
+    }
+    painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+    painter.setRenderHints(QPainter::Antialiasing);
+    painter.setClipRegion(m_shapesCacheDirty);
+
+    const QRect dirtyRect = m_shapesCacheDirty.boundingRect();
+    int painted = 0;
+    for (int i = 0; i < m_shapes.length(); i++) {
+        if (!isLiveShape(i) && shapeBounds(m_shapes[i]).intersects(dirtyRect)) {
+            paintShape(painter, m_shapes[i], i);
+            painted++;
+        }
+    }
+    painter.end();
+
+    qCDebug(paintLog) << "shapes cache:" << painted << "of" << m_shapes.length() << "shapes in"
+                      << dirtyRect << timer.elapsed() << "ms";
+    m_shapesCacheDirty = QRegion();
+    return m_shapesCache;
+}
+
+void ShapesWidget::paintEvent(QPaintEvent *event) {
     QPainter painter(this);
     painter.setRenderHints(QPainter::Antialiasing);
     QPen pen;
 
-    for(int i = 0; i < m_shapes.length(); i++) {
-        pen.setColor(colorIndexOf(m_shapes[i].colorIndex));
-        pen.setWidth(m_shapes[i].lineWidth);
-        painter.setPen(pen);
-        if (m_shapes[i].type == "rectangle") {
-            paintRect(painter, m_shapes[i].mainPoints, i, m_shapes[i].isBlur, m_shapes[i].isMosaic);
-        } else if (m_shapes[i].type == "oval") {
-            paintEllipse(painter, m_shapes[i].mainPoints, i, m_shapes[i].isBlur, m_shapes[i].isMosaic);
-        } else if (m_shapes[i].type == "arrow") {
-            paintArrow(painter, m_shapes[i].points, pen.width(), m_shapes[i].isStraight);
-        } else if (m_shapes[i].type == "line") {
-            paintLine(painter, m_shapes[i].points);
-        } else if (m_shapes[i].type == "text") {
-            if (!(m_editMap.value(i)->isReadOnly() && m_selectedIndex != i)) {
-                paintText(painter, m_shapes[i].mainPoints);
-            }
+    // Committed shapes are stroked once into the cache. Under the shapes
+    // which may change on this frame every shape is drawn live, in list
+    // order, so a selected shape doesn't rise above the later ones.
+    const QImage &cache = shapesCache();
+    const qreal ratio = cache.devicePixelRatio();
+    QVector<QRect> bounds;
+    QVector<int> liveShapes;
+    bounds.reserve(m_shapes.length());
+    for (int i = 0; i < m_shapes.length(); i++) {
+        bounds.append(shapeBounds(m_shapes[i]));
+        if (isLiveShape(i))
+            liveShapes.append(i);
+    }
+    ShapeLayers layers = splitShapeLayers(bounds, liveShapes, event->region());
+    for (const QRect &rect : layers.cached.rects()) {
+        painter.drawImage(rect, cache, QRectF(rect.topLeft()*ratio, rect.size()*ratio));
+    }
+    if (!layers.shapes.isEmpty()) {
+        painter.save();
+        painter.setClipRegion(layers.live);
+        foreach (int i, layers.shapes) {
+            paintShape(painter, m_shapes[i], i);
         }
+        painter.restore();
     }
 
-    if ((m_pos1 != QPointF(0, 0) && m_pos2 != QPointF(0, 0))||m_currentShape.type == "text") {
+    if ((m_pos1 != QPointF(0, 0) && m_pos2 != QPointF(0, 0))||m_currentShape.kind == Toolshape::Text) {
         FourPoints currentFPoint =  getMainPoints(m_pos1, m_pos2, m_isShiftPressed);
         pen.setColor(colorIndexOf(m_currentShape.colorIndex));
         pen.setWidth(m_currentShape.lineWidth);
         painter.setPen(pen);
-        if (m_currentType == "rectangle") {
-            paintRect(painter, currentFPoint, m_shapes.length(), m_currentShape.isBlur, m_currentShape.isMosaic);
-        } else if (m_currentType == "oval") {
-            paintEllipse(painter, currentFPoint, m_shapes.length(), m_currentShape.isBlur, m_currentShape.isMosaic);
-        } else if (m_currentType == "arrow") {
+        switch (m_currentKind) {
+        case Toolshape::Rectangle:
+            paintRect(painter, currentFPoint, m_shapes.length(), m_currentShape.effect);
+            break;
+        case Toolshape::Oval:
+            paintEllipse(painter, currentFPoint, m_shapes.length(), m_currentShape.effect);
+            break;
+        case Toolshape::Arrow:
             paintArrow(painter, m_currentShape.points, pen.width(), m_currentShape.isStraight);
-        } else if (m_currentType == "line") {
-            paintLine(painter, m_currentShape.points);
-        } else if (m_currentType == "text") {
+            break;
+        case Toolshape::Line:
+            paintLine(painter, m_currentShape.points, m_currentShape.path());
+            break;
+        case Toolshape::Text:
             if (m_editing) {
                 paintText(painter, m_currentShape.mainPoints);
             }
+            break;
+        default:
+            break;
         }
     }
 
@@ -1303,26 +1564,28 @@ void ShapesWidget::paintEvent(QPaintEvent *) {
         pen.setWidth(1);
         pen.setColor("#01bdff");
         painter.setPen(pen);
-        if (m_hoveredShape.type == "rectangle") {
-            paintRect(painter, m_hoveredShape.mainPoints,
-                              false, false);
-        } else if (m_hoveredShape.type == "oval") {
-            paintEllipse(painter, m_hoveredShape.mainPoints, -1);
-        } else if (m_hoveredShape.type == "arrow") {
+        switch (m_hoveredShape.kind) {
+        case Toolshape::Rectangle:
+        case Toolshape::Oval:
+            paintOutline(painter, m_hoveredShape.path(), -1);
+            break;
+        case Toolshape::Arrow:
             paintArrow(painter, m_hoveredShape.points, pen.width(), true);
-        } else if (m_hoveredShape.type == "line") {
-            paintLine(painter, m_hoveredShape.points);
+            break;
+        case Toolshape::Line:
+            paintLine(painter, m_hoveredShape.points, m_hoveredShape.path());
+            break;
+        default:
+            break;
         }
-    } else {
-        qDebug() << "hoveredShape.type:" << m_hoveredShape.type;
     }
 
     QPixmap resizePointImg(":/resources/images/size/resize_handle_big.png");
-    if (m_selectedShape.type == "arrow" && m_selectedShape.points.length() == 2) {
+    if (m_selectedShape.kind == Toolshape::Arrow && m_selectedShape.points.length() == 2) {
         paintImgPoint(painter, m_selectedShape.points[0], resizePointImg);
         paintImgPoint(painter, m_selectedShape.points[1], resizePointImg);
-    } else if (m_selectedShape.type != "text") {
-        if (m_selectedShape.mainPoints[0] != QPointF(0, 0) || m_selectedShape.type == "arrow") {
+    } else if (m_selectedShape.kind != Toolshape::Text) {
+        if (m_selectedShape.mainPoints[0] != QPointF(0, 0) || m_selectedShape.kind == Toolshape::Arrow) {
 
             QPointF rotatePoint = getRotatePoint(m_selectedShape.mainPoints[0],
                     m_selectedShape.mainPoints[1], m_selectedShape.mainPoints[2],
@@ -1346,7 +1609,7 @@ void ShapesWidget::paintEvent(QPaintEvent *) {
                 paintImgPoint(painter, anotherFPoints[j], resizePointImg);
             }
 
-            if (m_selectedShape.type == "oval" || m_selectedShape.type == "line") {
+            if (m_selectedShape.kind == Toolshape::Oval || m_selectedShape.kind == Toolshape::Line) {
                 paintRect(painter,  m_selectedShape.mainPoints, -1);
             }
         }
@@ -1355,7 +1618,7 @@ void ShapesWidget::paintEvent(QPaintEvent *) {
 
 void ShapesWidget::enterEvent(QEvent *e) {
     Q_UNUSED(e);
-    if (m_currentType != "line") {
+    if (m_currentKind != Toolshape::Line) {
         qApp->setOverrideCursor(setCursorShape(m_currentType));
     } else {
         qApp->setOverrideCursor(setCursorShape("line",  colorIndex(m_penColor)));
@@ -1411,26 +1674,29 @@ void ShapesWidget::enterEvent(QEvent *e) {
 //}
 
 void ShapesWidget::deleteCurrentShape() {
-    if (m_selectedIndex < m_shapes.length()) {
-        m_shapes.removeAt(m_selectedIndex);
+    const int deleteShapeIndex = m_selectedIndex;
+    if (deleteShapeIndex >= 0 && deleteShapeIndex < m_shapes.length()) {
+        invalidateShapesCache(shapeBounds(m_shapes[deleteShapeIndex]));
+        m_shapes.removeAt(deleteShapeIndex);
+        m_shapeIndex.removeAt(deleteShapeIndex);
     } else {
         qWarning() << "Invalid index";
     }
 
     clearSelected();
-    if (m_selectedShape.type == "text") {
-        m_editMap.value(m_selectedIndex)->clear();
-        delete m_editMap.value(m_selectedIndex);
-        m_editMap.remove(m_selectedIndex);
+    if (m_selectedShape.kind == Toolshape::Text) {
+        m_editMap.value(deleteShapeIndex)->clear();
+        delete m_editMap.value(deleteShapeIndex);
+        m_editMap.remove(deleteShapeIndex);
 
     }
-    m_selectedShape.type = "";
-    m_currentShape.type = "";
+    m_selectedShape.kind = Toolshape::NoKind;
+    m_currentShape.kind = Toolshape::NoKind;
     for(int i = 0; i < m_currentShape.mainPoints.length(); i++) {
         m_currentShape.mainPoints[i] = QPointF(0, 0);
     }
-    update();
-    m_selectedIndex = -1;
+    m_currentShape.invalidate();
+    updateLiveShapes();
 }
 
 void ShapesWidget::undoDrawShapes()
@@ -1441,20 +1707,22 @@ void ShapesWidget::undoDrawShapes()
             deleteCurrentShape();
     } else if (m_shapes.length() > 0) {
         int deleteShapeIndex = m_shapes.length() - 1;
-        if (m_shapes[deleteShapeIndex].type == "text") {
+        if (m_shapes[deleteShapeIndex].kind == Toolshape::Text) {
             m_editMap.value(deleteShapeIndex)->clear();
             delete m_editMap.value(deleteShapeIndex);
             m_editMap.remove(deleteShapeIndex);
         }
 
+        invalidateShapesCache(shapeBounds(m_shapes.last()));
         m_shapes.removeLast();
+        m_shapeIndex.removeAt(m_shapes.length());
     }
-    update();
+    updateLiveShapes();
 }
 
 QString ShapesWidget::getCurrentType()
 {
-    return m_currentShape.type;
+    return Toolshape::nameOf(m_currentShape.kind);
 }
 
 void ShapesWidget::microAdjust(QString direction) {
@@ -1467,9 +1735,12 @@ void ShapesWidget::microAdjust(QString direction) {
         } else {
             m_shapes[m_selectedIndex].mainPoints = pointResizeMicro(m_shapes[m_selectedIndex].mainPoints, direction, true);
         }
-        if (m_shapes[m_selectedIndex].type  == "text") {
+        m_shapes[m_selectedIndex].invalidate();
+        if (m_shapes[m_selectedIndex].kind == Toolshape::Text) {
+            updateShapeIndex(m_selectedIndex);
             return;
-        } else if (m_shapes[m_selectedIndex].type == "line" || m_shapes[m_selectedIndex].type == "arrow") {
+        } else if (m_shapes[m_selectedIndex].kind == Toolshape::Line
+                   || m_shapes[m_selectedIndex].kind == Toolshape::Arrow) {
             if (m_shapes[m_selectedIndex].portion.length() == 0) {
                 for(int k = 0; k < m_shapes[m_selectedIndex].points.length(); k++) {
                     m_shapes[m_selectedIndex].portion.append(relativePosition(m_shapes[m_selectedIndex].mainPoints,
@@ -1484,7 +1755,9 @@ void ShapesWidget::microAdjust(QString direction) {
 
         m_selectedShape.mainPoints = m_shapes[m_selectedIndex].mainPoints;
         m_selectedShape.points = m_shapes[m_selectedIndex].points;
-        update();
+        invalidateSelectedShape();
+        updateShapeIndex(m_selectedIndex);
+        updateLiveShapes();
     }
 }
 
@@ -3,9 +3,14 @@
 
 #include <QFrame>
 #include <QMouseEvent>
+#include <QPainterPath>
 
 #include "utils/shapesutils.h"
 #include "utils/baseutils.h"
+#include "utils/effectlayer.h"
+#include "utils/shapeindex.h"
+#include "utils/shapelayers.h"
+#include "utils/strokesimplifier.h"
 #include "textedit.h"
 #include "controller/menucontroller.h"
 
@@ -46,18 +51,19 @@ public slots:
     void handleResize(QPointF pos, int key);
 
     bool clickedOnShapes(QPointF pos);
-    bool clickedOnRect(FourPoints rectPoints, QPointF pos, bool isBlurMosaic = false);
-    bool clickedOnEllipse(FourPoints mainPoints, QPointF pos, bool isBlurMosaic = false);
+    bool clickedOnShape(Toolshape &shape, QPointF pos);
+    bool clickedOnRect(FourPoints rectPoints, QPointF pos, bool isEffect = false);
+    bool clickedOnEllipse(FourPoints mainPoints, QPointF pos, bool isEffect = false);
     bool clickedOnArrow(QList<QPointF> points, QPointF pos);
-    bool clickedOnLine(FourPoints mainPoints, QList<QPointF> points, QPointF pos);
+    bool clickedOnLine(FourPoints mainPoints, const StrokeIndex &stroke, QPointF pos);
     bool clickedOnText(FourPoints mainPoints, QPointF pos);
     bool rotateOnPoint(FourPoints mainPoints, QPointF pos);
 
-    bool hoverOnShapes(Toolshape toolShape, QPointF pos);
+    bool hoverOnShapes(const Toolshape &toolShape, QPointF pos);
     bool hoverOnRect(FourPoints rectPoints, QPointF pos);
     bool hoverOnEllipse(FourPoints mainPoints, QPointF pos);
     bool hoverOnArrow(QList<QPointF> points, QPointF pos);
-    bool hoverOnLine(FourPoints mainPoints, QList<QPointF> points, QPointF pos);
+    bool hoverOnLine(FourPoints mainPoints, const StrokeIndex &stroke, QPointF pos);
     bool hoverOnRotatePoint(FourPoints mainPoints, QPointF pos);
 
     void undoDrawShapes();
@@ -65,12 +71,15 @@ public slots:
     QString  getCurrentType();
     void microAdjust(QString direction);
     void setShiftKeyPressed(bool isShift);
+    /* the layer is shared by every shape of the effect until it is
+     * replaced, its tiles are computed as the shapes paint them */
+    void setEffectLayer(const QString &effect, const EffectLayer &layer);
 
 protected:
     void mousePressEvent(QMouseEvent* e);
     void mouseReleaseEvent(QMouseEvent* e);
     void mouseMoveEvent(QMouseEvent* e);
-    void paintEvent(QPaintEvent *);
+    void paintEvent(QPaintEvent *event);
     void enterEvent(QEvent *e);
 //    bool eventFilter(QObject *watched, QEvent *event);
 
@@ -96,14 +105,15 @@ private:
 
     int m_selectedIndex;
     int m_currentIndex;
-    bool m_blurEffectExist = false;
-    bool m_mosaicEffectExist = false;
+    QMap<QString, EffectLayer> m_effectLayers;
     QString m_currentType = "rectangle";
+    Toolshape::Kind m_currentKind = Toolshape::Rectangle;
     QColor m_penColor;
 
     Toolshape m_currentShape;
     Toolshape m_selectedShape;
     Toolshape m_hoveredShape;
+    StrokeSimplifier m_strokeSimplifier;
 
     QMap<int, TextEdit*> m_editMap;
     void updateTextRect(TextEdit* edit, QRectF newRect);
@@ -112,12 +122,50 @@ private:
 
     void paintImgPoint(QPainter &painter, QPointF pos, QPixmap img, bool isResize = true);
     void paintRect(QPainter &painter, FourPoints rectFPoints, int index,
-                               bool isBlur = false, bool isMosaic = false);
+                               const QString &effect = QString());
     void paintEllipse(QPainter &painter, FourPoints ellipseFPoints, int index,
-                                  bool isBlur = false, bool isMosaic = false);
+                                  const QString &effect = QString());
+    void paintOutline(QPainter &painter, const QPainterPath &path, int index,
+                      const QString &effect = QString());
     void paintArrow(QPainter &painter, QList<QPointF> lineFPoints,
                                   int lineWidth, bool isStraight = false);
-    void paintLine(QPainter &painter, QList<QPointF> lineFPoints);
+    /* draws path when it holds the points, a polyline otherwise */
+    void paintLine(QPainter &painter, QList<QPointF> lineFPoints,
+                   const QPainterPath &path = QPainterPath());
     void paintText(QPainter &painter, FourPoints rectFPoints);
+    void paintEffect(QPainter &painter, const QPainterPath &path,
+                     const QString &effect);
+    void paintShape(QPainter &painter, const Toolshape &shape, int index);
+
+    /* committed shapes rasterized once, the tiles under a shape are
+     * repainted when it is added, removed, selected or deselected */
+    bool isLiveShape(int index) const;
+    QRect cacheTiles(const QRect &rect) const;
+    void invalidateShapesCache(const QRect &rect);
+    void invalidateShapesCache();
+    const QImage &shapesCache();
+    QImage m_shapesCache;
+    QRegion m_shapesCacheDirty;
+    int m_cachedSelectedIndex = -1;
+
+    /* device space bounds with pen, arrow head and handles, mutations
+     * repaint only the old and new bounds of the live shapes */
+    QRect shapeBounds(const Toolshape &shape) const;
+    QRect handleBounds(const Toolshape &shape) const;
+    QRect selectedBounds() const;
+    QRect liveShapesBounds() const;
+    void updateLiveShapes();
+    QRect m_lastLiveRect;
+
+    /* narrows clicks and hovers to the shapes under the pointer, kept in
+     * step with m_shapes wherever a shape is added, changed or removed */
+    QRect hitBounds(const Toolshape &shape) const;
+    void appendShape(const Toolshape &shape);
+    void updateShapeIndex(int index);
+    void syncStrokeIndex(Toolshape &shape);
+    /* the selected shape changed in place, drop the paths and bounds of
+     * it and of its copies */
+    void invalidateSelectedShape();
+    ShapeIndex m_shapeIndex;
 };
 #endif // SHAPESWIDGET_H
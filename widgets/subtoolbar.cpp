@@ -4,6 +4,7 @@
 #include "textbutton.h"
 #include "utils/baseutils.h"
 #include "utils/configsettings.h"
+#include "utils/effectkernel.h"
 
 #include <dslider.h>
 
@@ -67,25 +68,53 @@ void SubToolBar::initRectLabel() {
     QLabel* vSeperatorLine = new QLabel();
     vSeperatorLine->setFixedSize(1, 16);
     vSeperatorLine->setObjectName("VerticalSeperatorLine");
-    //blur, mosaic...
-    ToolButton* blurBtn = new ToolButton();
-    blurBtn->setObjectName("BlurBtn");
-    ToolButton* mosaicBtn = new ToolButton();
-    mosaicBtn->setObjectName("MosaicBtn");
-    connect(blurBtn, &ToolButton::clicked, this, [=]{
-        ConfigSettings::instance()->setValue("effect", "is_blur", blurBtn->isChecked());
-        if (blurBtn->isChecked()) {
-            mosaicBtn->setChecked(false);
-            ConfigSettings::instance()->setValue("effect", "is_mosaic", false);
+    //blur, mosaic, redact, highlight...
+    QList<ToolButton*> effectBtnList;
+    foreach (QString effect, EffectKernel::names()) {
+        ToolButton* effectBtn = new ToolButton();
+        effectBtn->setObjectName(effect.left(1).toUpper() + effect.mid(1) + "Btn");
+        effectBtnList.append(effectBtn);
+    }
+    //effect size, effect shapes have no border so it takes the place
+    //of the line widths
+    QSlider* effectSizeSlider = new QSlider(Qt::Horizontal);
+    effectSizeSlider->setFixedWidth(58);
+    effectSizeSlider->setMinimum(2);
+    effectSizeSlider->setMaximum(40);
+    effectSizeSlider->setPageStep(2);
+    effectSizeSlider->setTracking(false);
+    effectSizeSlider->hide();
+    auto updateEffectSize = [=]{
+        QSharedPointer<const EffectKernel> kernel = EffectKernel::create(
+                    ConfigSettings::instance()->value("effect", "current").toString());
+        foreach (ToolButton* lineBtn, btnList) {
+            lineBtn->setVisible(!kernel);
         }
-    });
-    connect(mosaicBtn, &ToolButton::clicked, this, [=]{
-        ConfigSettings::instance()->setValue("effect", "is_mosaic", mosaicBtn->isChecked());
-        if (mosaicBtn->isChecked()) {
-            blurBtn->setChecked(false);
-            ConfigSettings::instance()->setValue("effect", "is_blur", false);
+        const bool hasSize = kernel && !kernel->sizeKey().isEmpty();
+        effectSizeSlider->setVisible(hasSize);
+        if (hasSize) {
+            QSignalBlocker blocker(effectSizeSlider);
+            effectSizeSlider->setValue(ConfigSettings::instance()->value(
+                                           "effect", kernel->sizeKey(), 10).toInt());
         }
+    };
+    connect(effectSizeSlider, &QSlider::valueChanged, this, [=](int size){
+        QSharedPointer<const EffectKernel> kernel = EffectKernel::create(
+                    ConfigSettings::instance()->value("effect", "current").toString());
+        if (kernel && !kernel->sizeKey().isEmpty())
+            ConfigSettings::instance()->setValue("effect", kernel->sizeKey(), size);
     });
+    for (int i = 0; i < effectBtnList.length(); i++) {
+        connect(effectBtnList[i], &ToolButton::clicked, this, [=]{
+            foreach (ToolButton* effectBtn, effectBtnList) {
+                if (effectBtn != effectBtnList[i])
+                    effectBtn->setChecked(false);
+            }
+            ConfigSettings::instance()->setValue("effect", "current",
+                            effectBtnList[i]->isChecked() ? EffectKernel::names()[i] : QString());
+            updateEffectSize();
+        });
+    }
     int lineWidthIndex = ConfigSettings::instance()->value("rectangle",
                                                       "linewidth_index").toInt();
     btnList[lineWidthIndex]->setChecked(true);
@@ -101,12 +130,14 @@ void SubToolBar::initRectLabel() {
                 ConfigSettings::instance()->setValue(m_currentType, "linewidth_index", i);
         });
     }
-    rectLayout->addSpacing(16);
+    rectLayout->addWidget(effectSizeSlider);
+    rectLayout->addSpacing(8);
     rectLayout->addWidget(vSeperatorLine);
-    rectLayout->addSpacing(16);
-    rectLayout->addWidget(blurBtn);
-    rectLayout->addSpacing(BUTTON_SPACING);
-    rectLayout->addWidget(mosaicBtn);
+    rectLayout->addSpacing(8);
+    foreach (ToolButton* effectBtn, effectBtnList) {
+        rectLayout->addWidget(effectBtn);
+        rectLayout->addSpacing(BUTTON_SPACING);
+    }
     rectLayout->addStretch();
     m_rectLabel->setLayout(rectLayout);
     addWidget(m_rectLabel);
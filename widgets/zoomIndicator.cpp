@@ -1,5 +1,7 @@
 #include "zoomIndicator.h"
 #include "utils/baseutils.h"
+#include "utils/configsettings.h"
+#include "utils/framestore.h"
 
 #include <QCursor>
 #include <QTextOption>
@@ -7,16 +9,18 @@
 #include <QRgb>
 
 namespace {
-const QSize BACKGROUND_SIZE = QSize(59, 59);
-const int SCALE_VALUE = 4;
-const int IMG_WIDTH =  12;
-const int INDICATOR_WIDTH = 49;
+const int MARGIN = 5;
 const int CENTER_RECT_WIDTH = 12;
 const int BOTTOM_RECT_HEIGHT = 14;
 }
 ZoomIndicator::ZoomIndicator(QWidget *parent)
     : QLabel(parent) {
-    setFixedSize(BACKGROUND_SIZE);
+    m_scale = qBound(2, ConfigSettings::instance()->value("zoom", "scale", 4).toInt(), 16);
+    m_patchSize = qBound(4, ConfigSettings::instance()->value("zoom", "patch_size", 12).toInt(), 64);
+    m_indicatorWidth = m_patchSize*m_scale + 1;
+    m_centerRectPix = QPixmap(":/resources/images/action/center_rect.png");
+
+    setFixedSize(m_indicatorWidth + MARGIN*2, m_indicatorWidth + MARGIN*2);
     setStyleSheet(getFileContent(":/resources/qss/zoomindicator.qss"));
     setAttribute(Qt::WA_TransparentForMouseEvents);
 }
@@ -25,29 +29,44 @@ ZoomIndicator::~ZoomIndicator() {}
 
 
 void ZoomIndicator::paintEvent(QPaintEvent *) {
-    using namespace utils;
     QPoint centerPos =  this->cursor().pos();
+    // The frame is grabbed in the coordinates of the overlay window.
+    QPoint framePos = parentWidget() ? parentWidget()->mapFromGlobal(centerPos) : centerPos;
+
+    QImage frameImg = FrameStore::instance()->frame();
+    if (!frameImg.rect().contains(framePos))
+        return;
 
-    qDebug() << "centerPos" << centerPos;
-    QRgb centerRectRgb = QImage(TMP_FULLSCREEN_FILE).pixel(centerPos);
-    QPixmap zoomPix = QPixmap(TMP_FULLSCREEN_FILE).copy(centerPos.x() - IMG_WIDTH/2,
-            centerPos.y() - IMG_WIDTH/2, IMG_WIDTH, IMG_WIDTH);
+    QRgb centerRectRgb;
+    if (frameImg.depth() == 32) {
+        centerRectRgb = reinterpret_cast<const QRgb*>(
+                    frameImg.constScanLine(framePos.y()))[framePos.x()];
+    } else {
+        centerRectRgb = frameImg.pixel(framePos);
+    }
 
-    zoomPix = zoomPix.scaled(QSize(INDICATOR_WIDTH,  INDICATOR_WIDTH),
-                             Qt::KeepAspectRatio);
+    // Sample the patch straight from the frame, clipped to its edges.
+    QRect patchRect(framePos.x() - m_patchSize/2, framePos.y() - m_patchSize/2,
+                    m_patchSize, m_patchSize);
+    QRect sourceRect = patchRect.intersected(frameImg.rect());
+    QRect targetRect(MARGIN + (sourceRect.x() - patchRect.x())*m_scale,
+                     MARGIN + (sourceRect.y() - patchRect.y())*m_scale,
+                     sourceRect.width()*m_scale, sourceRect.height()*m_scale);
 
     QPainter painter(this);
-    painter.drawPixmap(QRect(5, 5, INDICATOR_WIDTH, INDICATOR_WIDTH), zoomPix);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform, false);
+    painter.drawImage(targetRect, frameImg, sourceRect);
 
-    QRect centerRect = QRect((BACKGROUND_SIZE.width() - CENTER_RECT_WIDTH)/2 + 1,
-                             (BACKGROUND_SIZE.width() - CENTER_RECT_WIDTH)/2 + 1,
+    const int backgroundWidth = width();
+    QRect centerRect = QRect((backgroundWidth - CENTER_RECT_WIDTH)/2 + 1,
+                             (backgroundWidth - CENTER_RECT_WIDTH)/2 + 1,
                              CENTER_RECT_WIDTH, CENTER_RECT_WIDTH);
-    painter.drawPixmap(centerRect, QPixmap(":/resources/images/action/center_rect.png"));
-    painter.fillRect(QRect(INDICATOR_WIDTH/2 + 2, INDICATOR_WIDTH/2 + 2,
+    painter.drawPixmap(centerRect, m_centerRectPix);
+    painter.fillRect(QRect(m_indicatorWidth/2 + 2, m_indicatorWidth/2 + 2,
             CENTER_RECT_WIDTH - 4, CENTER_RECT_WIDTH - 4), QBrush(QColor(qRed(centerRectRgb),
              qGreen(centerRectRgb), qBlue(centerRectRgb))));
 
-    painter.fillRect(QRect(5, INDICATOR_WIDTH - 9, INDICATOR_WIDTH, BOTTOM_RECT_HEIGHT),
+    painter.fillRect(QRect(MARGIN, m_indicatorWidth - 9, m_indicatorWidth, BOTTOM_RECT_HEIGHT),
                      QBrush(QColor(0, 0, 0, 125)));
     QFont posFont;
     posFont.setPixelSize(9);
@@ -55,7 +74,7 @@ void ZoomIndicator::paintEvent(QPaintEvent *) {
     painter.setPen(QColor(Qt::white));
     QTextOption posTextOption;
     posTextOption.setAlignment(Qt::AlignHCenter | Qt::AlignTop);
-    painter.drawText(QRectF(5, INDICATOR_WIDTH - 10, INDICATOR_WIDTH, INDICATOR_WIDTH),
+    painter.drawText(QRectF(MARGIN, m_indicatorWidth - 10, m_indicatorWidth, m_indicatorWidth),
                      QString("%1, %2").arg(centerPos.x()).arg(centerPos.y()), posTextOption);
 }
 
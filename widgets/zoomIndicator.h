@@ -4,6 +4,7 @@
 #include <QLabel>
 #include <QPainter>
 #include <QPaintEvent>
+#include <QPixmap>
 
 class ZoomIndicator : public QLabel {
     Q_OBJECT
@@ -16,6 +17,12 @@ protected:
     void paintEvent(QPaintEvent *);
 
     QPoint m_pos;
+
+private:
+    int m_scale;
+    int m_patchSize;
+    int m_indicatorWidth;
+    QPixmap m_centerRectPix;
 };
 
 #endif // MAGNIFIER_H